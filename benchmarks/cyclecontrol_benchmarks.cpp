@@ -0,0 +1,405 @@
+#include <benchmark/benchmark.h>
+
+#include "flexcore/extended/ports/connection_buffer.hpp"
+#include "flexcore/pure/pure_ports.hpp"
+#include "flexcore/scheduler/cyclecontrol.hpp"
+#include "flexcore/scheduler/parallelscheduler.hpp"
+#include "flexcore/scheduler/serialschedulers.hpp"
+#include "flexcore/scheduler/timerfdmainloop.hpp"
+#include "flexcore/scheduler/workstealingscheduler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace fc
+{
+namespace bench
+{
+
+// Benchmarks of cycle_control running in realtime.
+
+constexpr int ticks_per_run = 200;
+
+struct realtime_loop
+{
+	static auto make() { return std::make_shared<thread::realtime_main_loop>(); }
+};
+
+struct timerfd_loop
+{
+	static auto make() { return std::make_shared<thread::timerfd_main_loop>(); }
+};
+
+/// timerfd loop which busy waits for the last 50us before every deadline
+struct timerfd_spin_loop
+{
+	static auto make()
+	{
+		return std::make_shared<thread::timerfd_main_loop>(std::chrono::microseconds(50));
+	}
+};
+
+/**
+ * Runs cycle_control with a base tick of state.range(0) microseconds in realtime
+ * and reports the deviation of the start times of a task running every base tick
+ * from the ideal period.
+ */
+template<class loop>
+void tick_jitter(benchmark::State& state)
+{
+	using clock = wall_clock::steady;
+	const auto base_tick = std::chrono::microseconds(state.range(0));
+
+	std::vector<clock::time_point> starts(ticks_per_run);
+	double max_jitter = 0.0;
+	double sum_jitter = 0.0;
+	size_t nr_of_samples = 0;
+
+	while (state.KeepRunning()) {
+		thread::cycle_control controller{std::make_unique<thread::parallel_scheduler>(),
+				[](auto&) { return true; }, // we only measure, overruns are counted as jitter
+				loop::make(), base_tick};
+		std::atomic<int> count{0};
+		controller.add_task(thread::periodic_task{[&]
+		{
+			const int i = count.load();
+			if (i < ticks_per_run)
+			{
+				starts[i] = clock::now();
+				count.store(i + 1);
+			}
+		}}, base_tick);
+
+		controller.start();
+		while (count.load() < ticks_per_run)
+			std::this_thread::sleep_for(base_tick);
+		controller.stop();
+
+		for (int i = 1; i < ticks_per_run; ++i)
+		{
+			const std::chrono::duration<double, std::micro> deviation =
+					starts[i] - starts[i - 1] - base_tick;
+			max_jitter = std::max(max_jitter, std::abs(deviation.count()));
+			sum_jitter += std::abs(deviation.count());
+			++nr_of_samples;
+		}
+	}
+	state.counters["mean_jitter_us"] = sum_jitter / std::max<size_t>(nr_of_samples, 1);
+	state.counters["max_jitter_us"] = max_jitter;
+}
+
+BENCHMARK_TEMPLATE(tick_jitter, realtime_loop)
+		->Arg(1000)->Arg(100)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_TEMPLATE(tick_jitter, timerfd_loop)
+		->Arg(1000)->Arg(100)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_TEMPLATE(tick_jitter, timerfd_spin_loop)
+		->Arg(1000)->Arg(100)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/**
+ * Measures the overhead of cycle_control for a single cycle with state.range(0) empty tasks,
+ * i.e. dispatching all tasks and waiting until they are done.
+ * The cycles are driven directly without pacing.
+ */
+void tick_overhead(benchmark::State& state)
+{
+	const auto nr_of_tasks = state.range(0);
+	auto loop = std::make_shared<thread::afap_main_loop>();
+	thread::cycle_control controller{std::make_unique<thread::work_stealing_scheduler>(),
+			[](auto&) { return true; }, loop};
+	// a non zero second argument enables inline execution of cheap tasks
+	controller.set_inline_threshold(std::chrono::microseconds(state.range(1)));
+	for (int i = 0; i != nr_of_tasks; ++i)
+		controller.add_task(thread::periodic_task{[]{}}, thread::cycle_control::min_tick_length);
+
+	while (state.KeepRunning())
+		loop->loop_body([&controller]{ controller.work(); });
+	loop->wait_for_current_tasks();
+
+	state.SetItemsProcessed(state.iterations() * nr_of_tasks);
+}
+
+BENCHMARK(tick_overhead)
+		->RangeMultiplier(4)->Ranges({{1, 1024}, {0, 0}})->UseRealTime();
+BENCHMARK(tick_overhead)
+		->RangeMultiplier(4)->Ranges({{1, 1024}, {10, 10}})->UseRealTime();
+
+/**
+ * Runs cycles of state.range(0) regions, each of which reads four large states
+ * through buffers from its neighbour region. Switching copies every state.
+ * state.range(1) helpers switch the buffers in parallel, zero switches serially.
+ */
+void large_state_switch(benchmark::State& state)
+{
+	using large_state = std::vector<double>;
+	constexpr int states_per_region = 4;
+	const auto nr_of_regions = state.range(0);
+	const large_state data(1 << 14, 1.0);
+	pure::state_source<large_state> source{[&data] { return data; }};
+
+	std::vector<std::unique_ptr<state_buffer<large_state>>> buffers;
+	std::vector<std::shared_ptr<parallel_region>> regions;
+	for (int i = 0; i != nr_of_regions; ++i)
+		regions.push_back(std::make_shared<parallel_region>(
+				"region " + std::to_string(i), thread::cycle_control::fast_tick));
+	for (int i = 0; i != nr_of_regions; ++i)
+	{
+		auto& consumer = *regions[i];
+		auto& producer = *regions[(i + 1) % nr_of_regions];
+		for (int j = 0; j != states_per_region; ++j)
+		{
+			buffers.push_back(std::make_unique<state_buffer<large_state>>());
+			auto& buffer = *buffers.back();
+			source >> buffer.in();
+			consumer.switch_tick() >> buffer.switch_active_passive_tick();
+			producer.work_tick() >> buffer.work_tick();
+		}
+	}
+
+	auto loop = std::make_shared<thread::afap_main_loop>();
+	thread::cycle_control controller{std::make_unique<thread::parallel_scheduler>(),
+			[](auto&) { return true; }, loop};
+	controller.set_parallel_switch(state.range(1));
+	for (const auto& region : regions)
+		controller.add_task(thread::periodic_task{region}, thread::cycle_control::fast_tick);
+
+	while (state.KeepRunning())
+		loop->loop_body([&controller] { controller.work(); });
+	loop->wait_for_current_tasks();
+
+	state.SetItemsProcessed(state.iterations() * nr_of_regions * states_per_region);
+}
+
+BENCHMARK(large_state_switch)
+		->RangeMultiplier(4)->Ranges({{16, 64}, {0, 0}})->UseRealTime();
+BENCHMARK(large_state_switch)
+		->RangeMultiplier(4)->Ranges({{16, 64}, {4, 4}})->UseRealTime();
+
+/**
+ * Measures the delay from the dispatch of a cycle to the start of a trivial
+ * latency critical region, while eight other regions keep the workers busy.
+ * state.range(0) selects how the critical region is executed:
+ * 0 by the pool of the scheduler, 1 by a dedicated thread, 2 by a spinning dedicated thread.
+ */
+void tick_to_start_latency(benchmark::State& state)
+{
+	using namespace std::chrono_literals;
+	thread::cycle_control controller{std::make_unique<thread::parallel_scheduler>(),
+			[](auto&) { return true; }, std::make_shared<thread::afap_main_loop>()};
+
+	std::vector<std::shared_ptr<parallel_region>> regions;
+	for (int i = 0; i != 8; ++i)
+	{
+		regions.push_back(std::make_shared<parallel_region>(
+				"load " + std::to_string(i), thread::cycle_control::fast_tick));
+		regions.back()->work_tick() >> []
+		{
+			const auto end = wall_clock::steady::now() + 50us;
+			while (wall_clock::steady::now() < end)
+				;
+		};
+	}
+	auto critical = std::make_shared<parallel_region>("critical", thread::cycle_control::fast_tick);
+	std::atomic<int> critical_runs{0};
+	critical->work_tick() >> [&critical_runs] { ++critical_runs; };
+	if (state.range(0) != 0)
+	{
+		dedicated_thread_config config;
+		config.spin = state.range(0) == 2;
+		critical->run_on_dedicated_thread(config);
+	}
+	// the critical region is added last, so it is queued behind the load
+	regions.push_back(critical);
+	for (const auto& region : regions)
+		controller.add_task(thread::periodic_task{region}, thread::cycle_control::fast_tick);
+
+	// dedicated threads only exist while the cycle_control runs
+	while (state.KeepRunning())
+	{
+		critical_runs.store(0);
+		controller.start();
+		while (critical_runs.load() < ticks_per_run)
+			std::this_thread::yield();
+		controller.stop();
+	}
+
+	const auto stats = controller.task_stats();
+	const auto critical_stats = std::find_if(stats.begin(), stats.end(),
+			[](const auto& task) { return task.name == "critical"; });
+	const auto& delay = critical_stats->start_delay;
+	using micros = std::chrono::duration<double, std::micro>;
+	state.counters["p50_start_us"] = micros(delay.percentile(50)).count();
+	state.counters["p99_start_us"] = micros(delay.percentile(99)).count();
+	state.counters["max_start_us"] = micros(delay.max).count();
+}
+
+BENCHMARK(tick_to_start_latency)
+		->DenseRange(0, 2)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/**
+ * Runs cycles of a single region with sixteen nodes, each of which busy waits for 50us.
+ * state.range(0) is the number of worker threads of the scheduler.
+ * With state.range(1) == 0 the nodes are connected to the work tick and run one after another,
+ * with 1 they are declared independent and are fanned out to the workers.
+ */
+void intra_region_scaling(benchmark::State& state)
+{
+	using namespace std::chrono_literals;
+	constexpr int nr_of_nodes = 16;
+	const auto threads = static_cast<int>(state.range(0));
+	const bool independent = state.range(1) != 0;
+
+	thread::cycle_control controller{std::make_unique<thread::parallel_scheduler>(
+			thread::scheduler_config::with_threads(threads)), [](auto&) { return true; },
+			std::make_shared<thread::afap_main_loop>()};
+	auto region = std::make_shared<parallel_region>("perception", thread::cycle_control::fast_tick);
+	const auto node_work = []
+	{
+		const auto end = wall_clock::steady::now() + 50us;
+		while (wall_clock::steady::now() < end)
+			;
+	};
+	for (int i = 0; i != nr_of_nodes; ++i)
+	{
+		if (independent)
+			region->independent_work_tick() >> node_work;
+		else
+			region->work_tick() >> node_work;
+	}
+	std::atomic<int> cycles{0};
+	region->work_tick() >> [&cycles] { ++cycles; };
+	controller.add_task(thread::periodic_task{region}, thread::cycle_control::fast_tick);
+
+	// lanes are only fanned out while the cycle_control runs
+	controller.start();
+	while (state.KeepRunning())
+	{
+		const int target = cycles.load() + 1;
+		while (cycles.load() < target)
+			std::this_thread::yield();
+	}
+	controller.stop();
+	state.SetItemsProcessed(state.iterations() * nr_of_nodes);
+}
+
+BENCHMARK(intra_region_scaling)
+		->RangeMultiplier(2)->Ranges({{1, 8}, {0, 1}})->UseRealTime();
+
+struct afap_loop
+{
+	static auto make() { return std::make_shared<thread::afap_main_loop>(); }
+};
+
+struct discrete_event_loop
+{
+	static auto make() { return std::make_shared<thread::discrete_event_main_loop>(); }
+};
+
+/**
+ * Simulates ten seconds of virtual time of a sparse workload,
+ * a few tasks with rates between 100ms and 1s on a base tick of state.range(0) microseconds,
+ * thus most cycles have no task which is due.
+ */
+template<class loop_t>
+void sparse_simulation(benchmark::State& state)
+{
+	using namespace std::chrono_literals;
+	const auto base_tick = std::chrono::microseconds(state.range(0));
+	const auto simulated = std::chrono::duration_cast<virtual_clock::steady::duration>(10s);
+	auto loop = loop_t::make();
+	thread::cycle_control controller{std::make_unique<thread::parallel_scheduler>(),
+			[](auto&) { return true; }, loop, base_tick};
+	std::atomic<int64_t> executed{0};
+	for (const auto rate : {100ms, 250ms, 1000ms})
+		controller.add_task(thread::periodic_task{[&executed] { ++executed; }}, rate);
+
+	while (state.KeepRunning())
+	{
+		const auto start = virtual_clock::steady::now();
+		while (virtual_clock::steady::now() - start < simulated)
+			loop->loop_body([&controller] { controller.work(); });
+	}
+	loop->wait_for_current_tasks();
+
+	state.SetItemsProcessed(executed.load());
+}
+
+BENCHMARK_TEMPLATE(sparse_simulation, afap_loop)
+		->Arg(10000)->Arg(1000)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_TEMPLATE(sparse_simulation, discrete_event_loop)
+		->Arg(10000)->Arg(1000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+constexpr int simulated_ticks = 20000;
+
+/// runs a small simulation of simulated_ticks cycles with the clock context given.
+void simulate(virtual_clock::context& context)
+{
+	auto loop = std::make_shared<thread::afap_main_loop>();
+	thread::cycle_control controller{std::make_unique<thread::blocking_scheduler>(),
+			[](auto&) { return true; }, loop};
+	controller.set_clock_context(context);
+	double state = 1.0;
+	controller.add_task(thread::periodic_task{[&state] { state = std::sqrt(state + 1.0); }},
+			thread::cycle_control::fast_tick);
+	controller.add_task(thread::periodic_task{[&state] { state = std::cos(state); }},
+			thread::cycle_control::medium_tick);
+	for (int i = 0; i != simulated_ticks; ++i)
+		loop->loop_body([&controller] { controller.work(); });
+	benchmark::DoNotOptimize(state);
+}
+
+/// runs state.range(0) independent simulations concurrently in threads of this process.
+void parallel_simulations_threads(benchmark::State& state)
+{
+	const auto nr_of_simulations = state.range(0);
+	while (state.KeepRunning())
+	{
+		std::vector<std::thread> simulations;
+		for (int i = 0; i != nr_of_simulations; ++i)
+			simulations.emplace_back([]
+			{
+				virtual_clock::context context;
+				simulate(context);
+			});
+		for (auto& simulation : simulations)
+			simulation.join();
+	}
+	state.SetItemsProcessed(state.iterations() * nr_of_simulations * simulated_ticks);
+}
+
+/// runs state.range(0) simulations concurrently, each in a process of its own.
+void parallel_simulations_processes(benchmark::State& state)
+{
+	const auto nr_of_simulations = state.range(0);
+	while (state.KeepRunning())
+	{
+		std::vector<pid_t> simulations;
+		for (int i = 0; i != nr_of_simulations; ++i)
+		{
+			const pid_t pid = fork();
+			if (pid == 0)
+			{
+				simulate(virtual_clock::context::process_default());
+				_exit(0);
+			}
+			simulations.push_back(pid);
+		}
+		for (const pid_t pid : simulations)
+			waitpid(pid, nullptr, 0);
+	}
+	state.SetItemsProcessed(state.iterations() * nr_of_simulations * simulated_ticks);
+}
+
+BENCHMARK(parallel_simulations_threads)
+		->RangeMultiplier(4)->Range(1, 64)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(parallel_simulations_processes)
+		->RangeMultiplier(4)->Range(1, 64)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}
+}
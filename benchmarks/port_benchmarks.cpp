@@ -2,10 +2,21 @@
 
 #include "flexcore/core/connection.hpp"
 #include "flexcore/core/connectables.hpp"
+#include "flexcore/extended/ports/connection_buffer.hpp"
+#include "flexcore/extended/ports/node_aware.hpp"
+#include "flexcore/scheduler/cyclecontrol.hpp"
 
 #include "benchmarkfunctions.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace fc
 {
@@ -101,12 +112,318 @@ void extended_node(benchmark::State& state) {
 	}
 }
 
+/**
+ * A 4MB grid crossing regions of different tick rates through a buffer.
+ * Every iteration pulls the grid on the work tick of the producer
+ * and switches the buffer on both sides.
+ */
+template<class buffer_t>
+void large_state_buffer(benchmark::State& state)
+{
+	using grid = std::vector<uint8_t>;
+	grid occupancy(4 << 20, 1);
+	buffer_t buffer{};
+	pure::state_source<grid> source{[&occupancy] { return occupancy; }};
+	source >> buffer.in();
+
+	while (state.KeepRunning())
+	{
+		buffer.work_tick()();
+		buffer.switch_passive_tick()();
+		buffer.switch_active_tick()();
+	}
+	state.SetBytesProcessed(state.iterations() * occupancy.size());
+}
+
+/// string payload of event_buffer benchmarks
+struct string_payload
+{
+	static std::string make() { return std::string(256, 'x'); }
+	static size_t size(const std::string& s) { return s.size(); }
+};
+
+/// vector payload of event_buffer benchmarks
+struct vector_payload
+{
+	static std::vector<float> make() { return std::vector<float>(256, 1.0f); }
+	static size_t size(const std::vector<float>& v) { return v.size(); }
+};
+
+/**
+ * 64 events per cycle crossing regions of different tick rates through an event_buffer.
+ * The producer fires newly created events, the consumer only looks at them,
+ * thus the benchmark measures the copies made by the buffer.
+ * With state.range(0) == 1 the consumer receives all events of a cycle in a batch.
+ */
+template<class payload>
+void event_buffer_delivery(benchmark::State& state)
+{
+	using event_t = decltype(payload::make());
+	constexpr int events_per_cycle = 64;
+	const event_t prototype = payload::make();
+	event_buffer<event_t> buffer{};
+	pure::event_source<event_t> source{};
+	size_t received = 0;
+	pure::event_sink<event_t> sink{[&received](const event_t& e) { received += payload::size(e); }};
+	pure::event_sink<event_batch<event_t>> batch_sink{[&received](event_batch<event_t> events)
+	{
+		for (const auto& e : events)
+			received += payload::size(e);
+	}};
+	source >> buffer.in();
+	if (state.range(0) == 1)
+		buffer.batch_out() >> batch_sink;
+	else
+		buffer.out() >> sink;
+
+	while (state.KeepRunning())
+	{
+		for (int i = 0; i != events_per_cycle; ++i)
+			source.fire(event_t(prototype));
+		buffer.switch_active_tick()();
+		buffer.switch_passive_tick()();
+		buffer.work_tick()();
+	}
+	benchmark::DoNotOptimize(received);
+	state.SetItemsProcessed(state.iterations() * events_per_cycle);
+}
+
+/**
+ * Same as event_buffer_delivery with a ring_event_buffer large enough for all events of a cycle.
+ * The ring needs no switch ticks, events are moved in on fire and out on the work tick.
+ */
+template<class payload>
+void ring_event_buffer_delivery(benchmark::State& state)
+{
+	using event_t = decltype(payload::make());
+	constexpr int events_per_cycle = 64;
+	const event_t prototype = payload::make();
+	ring_event_buffer<event_t> buffer{event_ring_config{events_per_cycle}};
+	pure::event_source<event_t> source{};
+	size_t received = 0;
+	pure::event_sink<event_t> sink{[&received](const event_t& e) { received += payload::size(e); }};
+	source >> buffer.in();
+	buffer.out() >> sink;
+
+	while (state.KeepRunning())
+	{
+		for (int i = 0; i != events_per_cycle; ++i)
+			source.fire(event_t(prototype));
+		buffer.work_tick()();
+	}
+	benchmark::DoNotOptimize(received);
+	state.SetItemsProcessed(state.iterations() * events_per_cycle);
+}
+
+/// ticks an event_buffer until fired events have reached its sinks
+template<class event_t>
+void deliver(event_buffer<event_t>& buffer)
+{
+	buffer.switch_active_tick()();
+	buffer.switch_passive_tick()();
+	buffer.work_tick()();
+}
+
+/// ticks a ring_event_buffer until fired events have reached its sinks
+template<class event_t>
+void deliver(ring_event_buffer<event_t>& buffer)
+{
+	buffer.work_tick()();
+}
+
+/// time from firing a single event to its arrival at the sink, including all ticks in between.
+template<class buffer_t>
+void event_handover_latency(benchmark::State& state)
+{
+	buffer_t buffer{};
+	pure::event_source<std::string> source{};
+	size_t received = 0;
+	pure::event_sink<std::string> sink{[&received](const std::string& s) { received += s.size(); }};
+	source >> buffer.in();
+	buffer.out() >> sink;
+	const std::string prototype(256, 'x');
+
+	while (state.KeepRunning())
+	{
+		source.fire(std::string(prototype));
+		deliver(buffer);
+	}
+	benchmark::DoNotOptimize(received);
+}
 
+/**
+ * Producer thread fires events into a ring_event_buffer as fast as possible,
+ * while the benchmark thread sends them on work ticks.
+ * state.range(0) is the capacity of the ring, events which don't fit are dropped.
+ */
+void event_ring_throughput(benchmark::State& state)
+{
+	ring_event_buffer<uint64_t> buffer{event_ring_config{static_cast<size_t>(state.range(0))}};
+	pure::event_source<uint64_t> source{};
+	uint64_t received = 0;
+	pure::event_sink<uint64_t> sink{[&received](uint64_t) { ++received; }};
+	source >> buffer.in();
+	buffer.out() >> sink;
+
+	std::atomic<bool> stop{false};
+	std::thread producer([&]
+	{
+		for (uint64_t i = 0; !stop.load(std::memory_order_relaxed); ++i)
+			source.fire(i);
+	});
+	while (state.KeepRunning())
+		buffer.work_tick()();
+	stop = true;
+	producer.join();
+
+	state.SetItemsProcessed(received);
+	state.counters["dropped"] = buffer.dropped();
+}
+
+/**
+ * time from firing an event on one thread to its arrival at the sink on another thread,
+ * which sends the events in the ring on work ticks as fast as possible.
+ */
+void event_ring_latency(benchmark::State& state)
+{
+	using clock = std::chrono::steady_clock;
+	ring_event_buffer<clock::time_point> buffer{};
+	pure::event_source<clock::time_point> source{};
+	std::atomic<int64_t> latency_ns{-1};
+	pure::event_sink<clock::time_point> sink{[&latency_ns](clock::time_point sent)
+	{
+		latency_ns.store((clock::now() - sent).count());
+	}};
+	source >> buffer.in();
+	buffer.out() >> sink;
+
+	std::atomic<bool> stop{false};
+	std::thread consumer([&]
+	{
+		while (!stop.load(std::memory_order_relaxed))
+		{
+			buffer.work_tick()();
+			std::this_thread::yield();
+		}
+	});
+	while (state.KeepRunning())
+	{
+		latency_ns.store(-1);
+		source.fire(clock::now());
+		while (latency_ns.load() < 0)
+			std::this_thread::yield();
+		state.SetIterationTime(std::chrono::duration<double>(
+				std::chrono::nanoseconds(latency_ns.load())).count());
+	}
+	stop = true;
+	consumer.join();
+}
+
+/**
+ * One event source fanned out to state.range(0) sinks in a region with another tick rate.
+ * Every iteration is one cycle with 64 events, all switch and work ticks included.
+ */
+void region_fan_out(benchmark::State& state)
+{
+	constexpr int events_per_cycle = 64;
+	parallel_region producer{"producer", thread::cycle_control::fast_tick};
+	parallel_region consumer{"consumer", thread::cycle_control::medium_tick};
+	node_aware<pure::event_source<std::string>> source{producer};
+	size_t received = 0;
+	std::vector<std::unique_ptr<node_aware<pure::event_sink<std::string>>>> sinks;
+	for (int i = 0; i != state.range(0); ++i)
+	{
+		sinks.push_back(std::make_unique<node_aware<pure::event_sink<std::string>>>(consumer,
+				[&received](const std::string& s) { received += s.size(); }));
+		source >> *sinks.back();
+	}
+	const std::string prototype(256, 'x');
+
+	while (state.KeepRunning())
+	{
+		for (int i = 0; i != events_per_cycle; ++i)
+			source.fire(std::string(prototype));
+		producer.ticks.switch_buffers();
+		consumer.ticks.switch_buffers();
+		consumer.ticks.in_work()();
+	}
+	benchmark::DoNotOptimize(received);
+	state.SetItemsProcessed(state.iterations() * events_per_cycle * state.range(0));
+}
+
+/// telemetry update of benchmark coalesced_telemetry
+using telemetry = std::pair<uint32_t, std::string>;
+
+/// creates the buffer of coalesced_telemetry
+template<class buffer_t>
+std::unique_ptr<buffer_t> make_telemetry_buffer();
+
+/// event_buffer buffers all updates
+template<>
+std::unique_ptr<event_buffer<telemetry>> make_telemetry_buffer()
+{
+	return std::make_unique<event_buffer<telemetry>>();
+}
+
+/// coalescing_event_buffer keeps the latest update per id
+template<>
+std::unique_ptr<coalescing_event_buffer<telemetry, uint32_t>> make_telemetry_buffer()
+{
+	return std::make_unique<coalescing_event_buffer<telemetry, uint32_t>>(
+			[](const telemetry& t) { return t.first; });
+}
+
+/**
+ * A fast region sends 1024 telemetry updates for 32 ids per cycle to a region,
+ * which only needs the latest update of every id.
+ * Measures the switch and work ticks, i.e. the time the consumer spends on the updates.
+ */
+template<class buffer_t>
+void coalesced_telemetry(benchmark::State& state)
+{
+	constexpr uint32_t updates_per_cycle = 1024;
+	constexpr uint32_t ids = 32;
+	auto buffer = make_telemetry_buffer<buffer_t>();
+	pure::event_source<telemetry> source{};
+	size_t received = 0;
+	pure::event_sink<telemetry> sink{[&received](const telemetry& t) { received += t.second.size(); }};
+	source >> buffer->in();
+	buffer->out() >> sink;
+	const std::string prototype(64, 'x');
+
+	while (state.KeepRunning())
+	{
+		for (uint32_t i = 0; i != updates_per_cycle; ++i)
+			source.fire(telemetry{i % ids, prototype});
+		const auto start = std::chrono::steady_clock::now();
+		buffer->switch_active_tick()();
+		buffer->switch_passive_tick()();
+		buffer->work_tick()();
+		const std::chrono::duration<double> consumer_time = std::chrono::steady_clock::now() - start;
+		state.SetIterationTime(consumer_time.count());
+	}
+	benchmark::DoNotOptimize(received);
+	state.SetItemsProcessed(state.iterations() * updates_per_cycle);
+}
 
 BENCHMARK(lambda);
 BENCHMARK(virtual_function);
 BENCHMARK(pure_port);
 BENCHMARK(extended_node);
+BENCHMARK_TEMPLATE(large_state_buffer, state_buffer<std::vector<uint8_t>>);
+BENCHMARK_TEMPLATE(large_state_buffer, triple_state_buffer<std::vector<uint8_t>>);
+BENCHMARK_TEMPLATE(event_buffer_delivery, string_payload)->DenseRange(0, 1);
+BENCHMARK_TEMPLATE(event_buffer_delivery, vector_payload)->DenseRange(0, 1);
+BENCHMARK_TEMPLATE(ring_event_buffer_delivery, string_payload);
+BENCHMARK_TEMPLATE(ring_event_buffer_delivery, vector_payload);
+BENCHMARK_TEMPLATE(event_handover_latency, event_buffer<std::string>);
+BENCHMARK_TEMPLATE(event_handover_latency, ring_event_buffer<std::string>);
+BENCHMARK(event_ring_throughput)->RangeMultiplier(16)->Range(16, 4096)->UseRealTime();
+BENCHMARK(event_ring_latency)->UseManualTime();
+BENCHMARK(region_fan_out)->Arg(1)->Arg(4)->Arg(20);
+BENCHMARK_TEMPLATE(coalesced_telemetry, event_buffer<telemetry>)->UseManualTime();
+BENCHMARK_TEMPLATE(coalesced_telemetry, coalescing_event_buffer<telemetry, uint32_t>)
+		->UseManualTime();
 
 }
 }
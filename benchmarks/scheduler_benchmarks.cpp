@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+
+#include "flexcore/scheduler/parallelscheduler.hpp"
+#include "flexcore/scheduler/workstealingscheduler.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace fc
+{
+namespace bench
+{
+
+// Benchmarks of the thread pools used by cycle_control.
+// Throughput is measured by adding a batch of tiny tasks and waiting for all of them,
+// wakeup latency by adding a single task to a pool whose workers are all asleep.
+
+constexpr int tasks_per_batch = 1000;
+
+struct parallel_pool
+{
+	static auto make(benchmark::State& state)
+	{
+		return std::make_unique<thread::parallel_scheduler>(
+				thread::scheduler_config::with_threads(static_cast<int>(state.range(0))));
+	}
+};
+
+struct work_stealing_pool
+{
+	static auto make(benchmark::State& state)
+	{
+		return std::make_unique<thread::work_stealing_scheduler>(
+				static_cast<int>(state.range(0)));
+	}
+};
+
+template<class pool>
+void scheduler_throughput(benchmark::State& state)
+{
+	auto scheduler = pool::make(state);
+	std::atomic<int> done{0};
+
+	while (state.KeepRunning()) {
+		done.store(0);
+		for (int i = 0; i != tasks_per_batch; ++i)
+			scheduler->add_task([&done]{ done.fetch_add(1, std::memory_order_relaxed); });
+		while (done.load() != tasks_per_batch)
+			std::this_thread::yield();
+	}
+	state.SetItemsProcessed(state.iterations() * tasks_per_batch);
+}
+
+/// like scheduler_throughput, but every batch is added with a single call to add_tasks.
+template<class pool>
+void scheduler_batch_throughput(benchmark::State& state)
+{
+	auto scheduler = pool::make(state);
+	std::atomic<int> done{0};
+	std::vector<thread::scheduled_task> batch;
+
+	while (state.KeepRunning()) {
+		done.store(0);
+		for (int i = 0; i != tasks_per_batch; ++i)
+			batch.push_back(thread::scheduled_task{
+					[&done]{ done.fetch_add(1, std::memory_order_relaxed); }});
+		scheduler->add_tasks(batch);
+		while (done.load() != tasks_per_batch)
+			std::this_thread::yield();
+	}
+	state.SetItemsProcessed(state.iterations() * tasks_per_batch);
+}
+
+template<class pool>
+void scheduler_wakeup_latency(benchmark::State& state)
+{
+	using clock = std::chrono::steady_clock;
+	auto scheduler = pool::make(state);
+	std::atomic<bool> started{false};
+	clock::time_point start_time;
+
+	while (state.KeepRunning()) {
+		// let all workers run out of work and go to sleep
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		started.store(false);
+		const auto submit_time = clock::now();
+		scheduler->add_task([&]
+		{
+			start_time = clock::now();
+			started.store(true);
+		});
+		while (!started.load())
+			std::this_thread::yield();
+
+		const std::chrono::duration<double> latency = start_time - submit_time;
+		state.SetIterationTime(latency.count());
+	}
+}
+
+BENCHMARK_TEMPLATE(scheduler_throughput, parallel_pool)
+		->RangeMultiplier(2)->Range(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(scheduler_throughput, work_stealing_pool)
+		->RangeMultiplier(2)->Range(1, 32)->UseRealTime();
+
+BENCHMARK_TEMPLATE(scheduler_batch_throughput, parallel_pool)
+		->RangeMultiplier(2)->Range(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(scheduler_batch_throughput, work_stealing_pool)
+		->RangeMultiplier(2)->Range(1, 32)->UseRealTime();
+
+BENCHMARK_TEMPLATE(scheduler_wakeup_latency, parallel_pool)
+		->RangeMultiplier(2)->Range(1, 32)->UseManualTime();
+BENCHMARK_TEMPLATE(scheduler_wakeup_latency, work_stealing_pool)
+		->RangeMultiplier(2)->Range(1, 32)->UseManualTime();
+
+}
+}
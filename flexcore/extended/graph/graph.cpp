@@ -3,9 +3,14 @@
 
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/graphviz.hpp>
+#include <boost/graph/strong_components.hpp>
+#include <boost/range/iterator_range.hpp>
 #include <boost/uuid/uuid_generators.hpp>
 
+#include <algorithm>
 #include <mutex>
+#include <queue>
+#include <vector>
 
 namespace fc
 {
@@ -188,5 +193,97 @@ void connection_graph::clear_graph()
 	graph.clear();
 }
 
+std::map<parallel_region*, size_t> region_waves(const connection_graph& graph)
+{
+	std::map<unique_id, std::vector<unique_id>> successors;
+	std::map<unique_id, parallel_region*> node_regions;
+	for (const auto& e : graph.edges())
+	{
+		const auto& source = e.source.node_properties;
+		const auto& sink = e.sink.node_properties;
+		successors[source.get_id()].push_back(sink.get_id());
+		node_regions[source.get_id()] = source.region();
+		node_regions[sink.get_id()] = sink.region();
+	}
+
+	std::map<parallel_region*, size_t> index;
+	std::vector<parallel_region*> regions;
+	for (const auto& node : node_regions)
+		if (node.second && index.emplace(node.second, regions.size()).second)
+			regions.push_back(node.second);
+
+	using region_graph_t = boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS>;
+	region_graph_t dependencies(regions.size());
+	for (const auto& node : node_regions)
+	{
+		parallel_region* const producer = node.second;
+		if (!producer)
+			continue;
+
+		// follow the data through nodes without region until it reaches the next regions.
+		std::vector<unique_id> open{successors[node.first]};
+		std::set<unique_id> visited;
+		while (!open.empty())
+		{
+			const auto id = open.back();
+			open.pop_back();
+			if (!visited.insert(id).second)
+				continue;
+
+			parallel_region* const consumer = node_regions[id];
+			if (!consumer)
+			{
+				const auto& next = successors[id];
+				open.insert(open.end(), next.begin(), next.end());
+			}
+			else if (consumer != producer
+					&& consumer->get_duration() == producer->get_duration())
+			{
+				boost::add_edge(index[producer], index[consumer], dependencies);
+			}
+		}
+	}
+
+	std::vector<size_t> component(regions.size());
+	const size_t nr_of_components = boost::strong_components(dependencies,
+			boost::make_iterator_property_map(
+					component.begin(), boost::get(boost::vertex_index, dependencies)));
+	std::vector<size_t> component_size(nr_of_components, 0);
+	for (const size_t c : component)
+		++component_size[c];
+	const auto cyclic = [&](size_t region) { return component_size[component[region]] > 1; };
+
+	// regions in cycles are left out, the rest is ordered by longest path from a source.
+	std::vector<size_t> nr_of_producers(regions.size(), 0);
+	for (const auto e : boost::make_iterator_range(boost::edges(dependencies)))
+		if (!cyclic(boost::source(e, dependencies)) && !cyclic(boost::target(e, dependencies)))
+			++nr_of_producers[boost::target(e, dependencies)];
+
+	std::vector<size_t> waves(regions.size(), 0);
+	std::queue<size_t> ready;
+	for (size_t region = 0; region != regions.size(); ++region)
+		if (!cyclic(region) && nr_of_producers[region] == 0)
+			ready.push(region);
+	while (!ready.empty())
+	{
+		const size_t producer = ready.front();
+		ready.pop();
+		for (const auto e : boost::make_iterator_range(boost::out_edges(producer, dependencies)))
+		{
+			const size_t consumer = boost::target(e, dependencies);
+			if (cyclic(consumer))
+				continue;
+			waves[consumer] = std::max(waves[consumer], waves[producer] + 1);
+			if (--nr_of_producers[consumer] == 0)
+				ready.push(consumer);
+		}
+	}
+
+	std::map<parallel_region*, size_t> result;
+	for (size_t region = 0; region != regions.size(); ++region)
+		result[regions[region]] = cyclic(region) ? parallel_region::unordered : waves[region];
+	return result;
+}
+
 } // namespace graph
 } // namespace fc
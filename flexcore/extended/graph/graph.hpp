@@ -161,6 +161,17 @@ private:
 	std::unique_ptr<impl> pimpl;
 };
 
+/**
+ * \brief orders the regions in graph by the flow of data between them.
+ *
+ * A region depends on another region with the same tick rate, if data flows from the
+ * other region to it, either directly or through nodes which don't belong to a region.
+ * Every region is assigned a wave, which is larger than the waves of all regions it depends on.
+ * Regions in cyclic dependencies can't be ordered and get parallel_region::unordered.
+ * \returns the wave of every region in graph
+ */
+std::map<parallel_region*, size_t> region_waves(const connection_graph& graph);
+
 } // namespace graph
 } // namespace fc
 
@@ -15,6 +15,19 @@
 namespace fc
 {
 
+/// declares if the action of a region_worker_node depends on other work of its region
+enum class worker_mode
+{
+	/// action runs one after another with the other work of the region
+	sequential,
+	/**
+	 * action neither reads nor writes data of other nodes of the region,
+	 * and may run concurrently with other independent work of the region.
+	 * \see parallel_region::independent_work_tick
+	 */
+	independent
+};
+
 /**
  * \brief node which executes action on work tick of given region
  *
@@ -26,10 +39,14 @@ class region_worker_node : public tree_base_node
 {
 public:
 	template <class action_t>
-	region_worker_node(action_t&& action, const node_args& node)
+	region_worker_node(action_t&& action, const node_args& node,
+			worker_mode mode = worker_mode::sequential)
 	    : tree_base_node(node)
 	{
-		region()->work_tick() >> std::forward<action_t>(action);
+		if (mode == worker_mode::independent)
+			region()->independent_work_tick() >> std::forward<action_t>(action);
+		else
+			region()->work_tick() >> std::forward<action_t>(action);
 	}
 
 };
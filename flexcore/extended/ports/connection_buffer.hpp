@@ -1,10 +1,23 @@
 #ifndef SRC_PORTS_CONNECTION_BUFFER_HPP_
 #define SRC_PORTS_CONNECTION_BUFFER_HPP_
 
+#include <atomic>
+#include <cassert>
+#include <cstddef>
 #include <functional>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/container/flat_map.hpp>
+#include <boost/range/iterator_range.hpp>
 
 #include "pure/pure_ports.hpp"
+#include "extended/ports/event_ring_config.hpp"
 #include "extended/ports/token_tags.hpp"
 
 namespace fc
@@ -67,6 +80,10 @@ private:
 	pure::event_source<token_t> out_event_port;
 };
 
+/// events delivered at once by event_buffer::batch_out, only valid during the call.
+template<class event_t>
+using event_batch = boost::iterator_range<typename std::vector<event_t>::const_iterator>;
+
 /**
  * \brief buffer for events using double buffering
  *
@@ -75,6 +92,8 @@ private:
  * This moves events from internal to external buffer.
  * New events are added to to the internal buffer.
  * Events from the external buffer are fired on receiving send tick.
+ * Events are moved through all buffers, they are only copied
+ * if more than one sink is connected to out.
  */
 template<class event_t>
 class event_buffer final : public buffer_interface<event_t, event_tag>
@@ -83,9 +102,18 @@ public:
 	event_buffer()
 		: switch_active_tick_([this] { switch_active_buffers(); })
 		, switch_passive_tick_([this] { switch_passive_buffers(); })
-		, switch_active_passive_tick_([this] { switch_active_passive_buffers(); })
+		, switch_active_passive_tick_([this]
+				{
+					if (!handing_off())
+						switch_active_passive_buffers();
+				})
+		, handoff_tick_([this]
+				{
+					if (handing_off())
+						switch_active_passive_buffers();
+				})
 		, in_send_tick( [this](){ send_events(); } )
-		, in_event_port( [this](event_t in_event) { intern_buffer.push_back(in_event);})
+		, in_event_port( [this](event_t in_event) { intern_buffer.push_back(std::move(in_event));})
 		, intern_buffer()
 		, extern_buffer()
 		, read(false)
@@ -99,15 +127,47 @@ public:
 	auto& switch_active_tick() { return switch_active_tick_; }
 	/// event in port of type void, switches passive-side buffers
 	auto& switch_passive_tick() { return switch_passive_tick_; }
-	/// event in port of type void, directly switches active- and passive-side buffers
+	/**
+	 * \brief event in port of type void, directly switches active- and passive-side buffers
+	 * unless the buffer hands off events, see hand_off_if.
+	 */
 	auto& switch_active_passive_tick() { return switch_active_passive_tick_; }
+	/**
+	 * \brief event in port of type void, switches active- and passive-side buffers
+	 * if the buffer hands off events, see hand_off_if.
+	 */
+	auto& handoff_tick() { return handoff_tick_; }
 	/// event in port of type void, fires outgoing buffer
 	auto& work_tick() { return in_send_tick; }
 
+	/**
+	 * \brief sets the condition under which events are handed off within a cycle.
+	 *
+	 * While condition returns true, events are made available to the passive side on
+	 * handoff_tick instead of switch_active_passive_tick.
+	 */
+	void hand_off_if(std::function<bool()> condition) { handoff_condition = std::move(condition); }
+
 	in_port_t& in() override { return in_event_port; }
 	out_port_t& out() override { return out_event_port; }
+	/**
+	 * \brief event out port, which sends all events of a work tick in a single call.
+	 *
+	 * Receives the events before they are fired one by one at out.
+	 * Sinks which handle whole batches save the call per event, nothing is sent without events.
+	 */
+	pure::event_source<event_batch<event_t>>& batch_out() { return batch_out_port; }
 
 private:
+	bool handing_off() const { return handoff_condition && handoff_condition(); }
+
+	/// appends all events of from to to and leaves from empty.
+	static void append(std::vector<event_t>& from, std::vector<event_t>& to)
+	{
+		to.insert(end(to), std::make_move_iterator(begin(from)), std::make_move_iterator(end(from)));
+		from.clear();
+	}
+
 	/**
 	 * \brief switches intern_buffer to middle_buffer
 	 * \post intern_buffer.empty()
@@ -121,7 +181,7 @@ private:
 		if (read)
 			swap(intern_buffer, middle_buffer);
 		else
-			middle_buffer.insert(end(middle_buffer), begin(intern_buffer), end(intern_buffer));
+			append(intern_buffer, middle_buffer);
 		read = false;
 		intern_buffer.clear();
 		assert(intern_buffer.empty());
@@ -156,8 +216,7 @@ private:
 		}
 		else
 		{
-			extern_buffer.insert(end(extern_buffer), begin(intern_buffer), end(intern_buffer));
-			intern_buffer.clear();
+			append(intern_buffer, extern_buffer);
 		}
 		assert(intern_buffer.empty());
 	}
@@ -168,8 +227,10 @@ private:
 	 */
 	void send_events()
 	{
-		for (event_t e : extern_buffer)
-			out_event_port.fire(e);
+		if (!extern_buffer.empty() && batch_out_port.nr_connected_handlers() != 0)
+			batch_out_port.fire(event_batch<event_t>(extern_buffer));
+		for (auto&& e : extern_buffer)
+			out_event_port.fire(std::move(e));
 
 		// delete content of extern buffer, do not change capacity,
 		// since we want to avoid allocations in next cycle.
@@ -180,9 +241,12 @@ private:
 	pure::event_sink<void> switch_active_tick_;
 	pure::event_sink<void> switch_passive_tick_;
 	pure::event_sink<void> switch_active_passive_tick_;
+	pure::event_sink<void> handoff_tick_;
 	pure::event_sink<void> in_send_tick;
 	in_port_t in_event_port;
 	out_port_t out_event_port;
+	pure::event_source<event_batch<event_t>> batch_out_port;
+	std::function<bool()> handoff_condition;
 
 	using buffer_t = std::vector<event_t>;
 	buffer_t intern_buffer;
@@ -203,7 +267,16 @@ public:
 	event_buffer()
 		: switch_active_tick_([this] { switch_active_buffers(); })
 		, switch_passive_tick_([this] { switch_passive_buffers(); })
-		, switch_active_passive_tick_([this] { switch_active_passive_buffers(); })
+		, switch_active_passive_tick_([this]
+				{
+					if (!handing_off())
+						switch_active_passive_buffers();
+				})
+		, handoff_tick_([this]
+				{
+					if (handing_off())
+						switch_active_passive_buffers();
+				})
 		, in_send_tick( [this](){ send_events(); } )
 		, in_event_port( [this]() { intern_buffer++;})
 		, intern_buffer(0)
@@ -222,13 +295,20 @@ public:
 	auto& switch_passive_tick() { return switch_passive_tick_; }
 	/// event in port of type void, directly switches active- and passive-side buffers
 	auto& switch_active_passive_tick() { return switch_active_passive_tick_; }
+	/// event in port of type void, switches active- and passive-side buffers when handing off
+	auto& handoff_tick() { return handoff_tick_; }
 	/// event in port of type void, fires out port once for each event stored.
 	auto& work_tick() { return in_send_tick; }
 
+	/// \see event_buffer::hand_off_if
+	void hand_off_if(std::function<bool()> condition) { handoff_condition = std::move(condition); }
+
 	in_port_t& in() override { return in_event_port; }
 	out_port_t& out() override { return out_event_port; }
 
 private:
+	bool handing_off() const { return handoff_condition && handoff_condition(); }
+
 	void switch_active_buffers()
 	{
 		if (read)
@@ -270,9 +350,11 @@ private:
 	pure::event_sink<void> switch_active_tick_;
 	pure::event_sink<void> switch_passive_tick_;
 	pure::event_sink<void> switch_active_passive_tick_;
+	pure::event_sink<void> handoff_tick_;
 	pure::event_sink<void> in_send_tick;
 	in_port_t in_event_port;
 	out_port_t out_event_port;
+	std::function<bool()> handoff_condition;
 
 	size_t intern_buffer;
 	size_t extern_buffer;
@@ -320,9 +402,19 @@ public:
 	auto& switch_passive_tick() { return switch_passive_tick_; }
 	/// event in port of type void, directly switches active- and passive-side buffers
 	auto& switch_active_passive_tick() { return switch_active_passive_tick_; }
+	/// event in port of type void, pulls data at in_port and publishes it when handing off
+	auto& handoff_tick() { return handoff_tick_; }
 	/// event in port of type void, pulls data at in_port
 	auto& work_tick() { return in_work_tick; }
 
+	/**
+	 * \brief sets the condition under which the state is handed off within a cycle.
+	 *
+	 * While condition returns true, work_tick and switch_active_passive_tick are ignored
+	 * and handoff_tick pulls the state and makes it available at once.
+	 */
+	void hand_off_if(std::function<bool()> condition) { handoff_condition = std::move(condition); }
+
 	pure::state_sink<data_t>& in() override
 	{
 		return in_port;
@@ -348,18 +440,770 @@ private:
 		extern_buffer = intern_buffer;
 	}
 
+	bool handing_off() const { return handoff_condition && handoff_condition(); }
+
 	pure::event_sink<void> switch_active_tick_;
 	pure::event_sink<void> switch_passive_tick_;
 	pure::event_sink<void> switch_active_passive_tick_;
+	pure::event_sink<void> handoff_tick_;
 	pure::event_sink<void> in_work_tick;
 	pure::state_sink<data_t> in_port;
 	pure::state_source<data_t> out_port;
+	std::function<bool()> handoff_condition;
 
 	data_t intern_buffer;
 	data_t extern_buffer;
 	data_t middle_buffer;
 };
 
+/**
+ * \brief buffer for states, which swaps pointers to its slots instead of copying states.
+ *
+ * Has the same ticks and behavior as state_buffer, but keeps the three buffers on the heap.
+ * The work tick moves the pulled state into the internal slot, switch ticks only swap slots,
+ * thus a tick costs at most the copy made by the source of the state.
+ * Slots are only swapped if they received a new state since the last switch.
+ * Worthwhile for large states and states with expensive copies,
+ * buffer_factory uses it for those automatically.
+ *
+ * \tparam data_t type of state stored in buffer. needs to be default and copy constructable.
+ */
+template<class data_t>
+class triple_state_buffer final : public buffer_interface<data_t, state_tag>
+{
+public:
+	triple_state_buffer()
+		: switch_active_tick_([this] { switch_active_buffers(); })
+		, switch_passive_tick_([this] { switch_passive_buffers(); })
+		, switch_active_passive_tick_([this]
+				{
+					if (!handing_off())
+						switch_active_passive_buffers();
+				})
+		, handoff_tick_([this]
+				{
+					if (handing_off())
+						*extern_buffer = in_port.get();
+				})
+		, in_work_tick([this]
+				{
+					if (handing_off())
+						return;
+					*intern_buffer = in_port.get();
+					intern_fresh = true;
+				})
+		, in_port()
+		, out_port([this] { return *extern_buffer; })
+	{
+	}
+
+	/// \see state_buffer::switch_active_tick
+	auto& switch_active_tick() { return switch_active_tick_; }
+	/// \see state_buffer::switch_passive_tick
+	auto& switch_passive_tick() { return switch_passive_tick_; }
+	/// \see state_buffer::switch_active_passive_tick
+	auto& switch_active_passive_tick() { return switch_active_passive_tick_; }
+	/// \see state_buffer::handoff_tick
+	auto& handoff_tick() { return handoff_tick_; }
+	/// \see state_buffer::work_tick
+	auto& work_tick() { return in_work_tick; }
+
+	/// \see state_buffer::hand_off_if
+	void hand_off_if(std::function<bool()> condition) { handoff_condition = std::move(condition); }
+
+	pure::state_sink<data_t>& in() override { return in_port; }
+	pure::state_source<data_t>& out() override { return out_port; }
+
+private:
+	void switch_passive_buffers()
+	{
+		if (!intern_fresh)
+			return;
+		swap(intern_buffer, middle_buffer);
+		intern_fresh = false;
+		middle_fresh = true;
+	}
+
+	void switch_active_buffers()
+	{
+		if (!middle_fresh)
+			return;
+		swap(middle_buffer, extern_buffer);
+		middle_fresh = false;
+	}
+
+	void switch_active_passive_buffers()
+	{
+		if (!intern_fresh)
+			return;
+		swap(intern_buffer, extern_buffer);
+		intern_fresh = false;
+	}
+
+	bool handing_off() const { return handoff_condition && handoff_condition(); }
+
+	pure::event_sink<void> switch_active_tick_;
+	pure::event_sink<void> switch_passive_tick_;
+	pure::event_sink<void> switch_active_passive_tick_;
+	pure::event_sink<void> handoff_tick_;
+	pure::event_sink<void> in_work_tick;
+	pure::state_sink<data_t> in_port;
+	pure::state_source<data_t> out_port;
+	std::function<bool()> handoff_condition{};
+
+	std::unique_ptr<data_t> intern_buffer = std::make_unique<data_t>();
+	std::unique_ptr<data_t> extern_buffer = std::make_unique<data_t>();
+	std::unique_ptr<data_t> middle_buffer = std::make_unique<data_t>();
+	/// true if intern_buffer holds a state, which has not been switched yet
+	bool intern_fresh = false;
+	/// true if middle_buffer holds a state, which has not been switched yet
+	bool middle_fresh = false;
+};
+
+namespace detail
+{
+/**
+ * \brief latest event for every key, see coalescing_event_buffer.
+ *
+ * Events are kept in the order in which their keys arrived first.
+ * Keys, events and the index of the keys are stored in contiguous memory,
+ * clearing keeps the memory for the next cycle.
+ */
+template<class event_t, class key_t>
+struct coalesced_events
+{
+	/// replaces the event with the same key or appends event, if the key is new.
+	void put(key_t key, event_t&& event)
+	{
+		const auto position = index.find(key);
+		if (position != index.end())
+		{
+			events[position->second] = std::move(event);
+			return;
+		}
+		index.emplace(key, events.size());
+		keys.push_back(std::move(key));
+		events.push_back(std::move(event));
+	}
+
+	/// puts all events of from, which is left empty.
+	void merge(coalesced_events& from)
+	{
+		for (size_t i = 0; i != from.events.size(); ++i)
+			put(std::move(from.keys[i]), std::move(from.events[i]));
+		from.clear();
+	}
+
+	void clear()
+	{
+		keys.clear();
+		events.clear();
+		index.clear();
+	}
+
+	bool empty() const { return events.empty(); }
+
+	friend void swap(coalesced_events& lhs, coalesced_events& rhs)
+	{
+		using std::swap;
+		swap(lhs.keys, rhs.keys);
+		swap(lhs.events, rhs.events);
+		swap(lhs.index, rhs.index);
+	}
+
+	std::vector<key_t> keys;
+	std::vector<event_t> events;
+	/// position of the event of every key in events
+	boost::container::flat_map<key_t, size_t> index;
+};
+}
+
+/**
+ * \brief buffer for events, which only keeps the latest event for every key.
+ *
+ * Has the same ticks as event_buffer and hands events over at the same time,
+ * but an event replaces all earlier events with the same key, which have not been sent yet.
+ * Thus the consumer only receives the most recent events, no matter how many events
+ * the producer has sent in the meantime, and the memory used is bounded by the number of keys.
+ * Events of a work tick are sent in the order in which their keys arrived.
+ * \tparam event_t type of events, needs to be move constructible and move assignable.
+ * \tparam key_t type of the keys, needs to be copyable and less than comparable.
+ * \see node_aware::keep_latest_event_per_key
+ */
+template<class event_t, class key_t>
+class coalescing_event_buffer final : public buffer_interface<event_t, event_tag>
+{
+public:
+	/// \param key_of extracts the key of an event
+	explicit coalescing_event_buffer(std::function<key_t(const event_t&)> key_of)
+		: switch_active_tick_([this] { switch_active_buffers(); })
+		, switch_passive_tick_([this] { switch_passive_buffers(); })
+		, switch_active_passive_tick_([this]
+				{
+					if (!handing_off())
+						switch_active_passive_buffers();
+				})
+		, handoff_tick_([this]
+				{
+					if (handing_off())
+						switch_active_passive_buffers();
+				})
+		, in_send_tick([this] { send_events(); })
+		, in_event_port([this](event_t in_event)
+				{
+					auto key = this->key_of(in_event);
+					intern_buffer.put(std::move(key), std::move(in_event));
+				})
+		, key_of(std::move(key_of))
+	{
+		assert(this->key_of);
+	}
+
+	using out_port_t = typename pure::out_port<event_t, event_tag>::type;
+	using in_port_t = typename pure::in_port<event_t, event_tag>::type;
+
+	/// \see event_buffer::switch_active_tick
+	auto& switch_active_tick() { return switch_active_tick_; }
+	/// \see event_buffer::switch_passive_tick
+	auto& switch_passive_tick() { return switch_passive_tick_; }
+	/// \see event_buffer::switch_active_passive_tick
+	auto& switch_active_passive_tick() { return switch_active_passive_tick_; }
+	/// \see event_buffer::handoff_tick
+	auto& handoff_tick() { return handoff_tick_; }
+	/// event in port of type void, fires the latest events
+	auto& work_tick() { return in_send_tick; }
+
+	/// \see event_buffer::hand_off_if
+	void hand_off_if(std::function<bool()> condition) { handoff_condition = std::move(condition); }
+
+	in_port_t& in() override { return in_event_port; }
+	out_port_t& out() override { return out_event_port; }
+
+private:
+	bool handing_off() const { return handoff_condition && handoff_condition(); }
+
+	/// \see event_buffer::switch_active_buffers
+	void switch_active_buffers()
+	{
+		if (read)
+			swap(intern_buffer, middle_buffer);
+		else
+			middle_buffer.merge(intern_buffer);
+		read = false;
+		intern_buffer.clear();
+	}
+
+	/// \see event_buffer::switch_passive_buffers
+	void switch_passive_buffers()
+	{
+		swap(middle_buffer, extern_buffer);
+		read = true;
+		middle_buffer.clear();
+	}
+
+	/// \see event_buffer::switch_active_passive_buffers
+	void switch_active_passive_buffers()
+	{
+		if (extern_buffer.empty())
+			swap(intern_buffer, extern_buffer);
+		else
+			extern_buffer.merge(intern_buffer);
+		intern_buffer.clear();
+	}
+
+	void send_events()
+	{
+		for (auto&& e : extern_buffer.events)
+			out_event_port.fire(std::move(e));
+		extern_buffer.clear();
+	}
+
+	pure::event_sink<void> switch_active_tick_;
+	pure::event_sink<void> switch_passive_tick_;
+	pure::event_sink<void> switch_active_passive_tick_;
+	pure::event_sink<void> handoff_tick_;
+	pure::event_sink<void> in_send_tick;
+	in_port_t in_event_port;
+	out_port_t out_event_port;
+	std::function<bool()> handoff_condition;
+	std::function<key_t(const event_t&)> key_of;
+
+	using buffer_t = detail::coalesced_events<event_t, key_t>;
+	buffer_t intern_buffer;
+	buffer_t extern_buffer;
+	buffer_t middle_buffer;
+	bool read = false;
+};
+
+/**
+ * \brief buffer for events between regions which don't run in lockstep.
+ *
+ * Used for connections to and from event triggered regions (see parallel_region::trigger_on_events),
+ * which run whenever events arrive and not at the ticks of the other side.
+ * Events are collected in an internal buffer on the producing side and published
+ * to an inbox on publish_tick, which is sent when the producer is done with its work.
+ * The consuming side takes all published events out of the inbox on collect_tick,
+ * only publishing and collecting synchronize with each other.
+ */
+template<class event_t>
+class event_inbox final : public buffer_interface<event_t, event_tag>
+{
+public:
+	event_inbox()
+		: publish_tick_([this] { publish(); })
+		, collect_tick_([this] { collect(); })
+		, in_send_tick([this] { send_events(); })
+		, in_event_port([this](event_t in_event) { intern_buffer.push_back(std::move(in_event)); })
+	{
+	}
+
+	using out_port_t = typename pure::out_port<event_t, event_tag>::type;
+	using in_port_t = typename pure::in_port<event_t, event_tag>::type;
+
+	/// event in port of type void, makes the events received so far available to the consumer
+	auto& publish_tick() { return publish_tick_; }
+	/// event in port of type void, takes the published events for sending
+	auto& collect_tick() { return collect_tick_; }
+	/// event in port of type void, fires the collected events
+	auto& work_tick() { return in_send_tick; }
+
+	/// sets a function, which is called whenever new events have been published.
+	void on_publish(std::function<void()> notify) { published = std::move(notify); }
+
+	in_port_t& in() override { return in_event_port; }
+	out_port_t& out() override { return out_event_port; }
+
+private:
+	void publish()
+	{
+		if (intern_buffer.empty())
+			return;
+		{
+			std::lock_guard<std::mutex> lock(inbox_mutex);
+			if (inbox.empty())
+				swap(intern_buffer, inbox);
+			else
+				inbox.insert(end(inbox), std::make_move_iterator(begin(intern_buffer)),
+						std::make_move_iterator(end(intern_buffer)));
+		}
+		intern_buffer.clear();
+		if (published)
+			published();
+	}
+
+	void collect()
+	{
+		std::lock_guard<std::mutex> lock(inbox_mutex);
+		if (extern_buffer.empty())
+			swap(inbox, extern_buffer);
+		else
+			extern_buffer.insert(end(extern_buffer), std::make_move_iterator(begin(inbox)),
+					std::make_move_iterator(end(inbox)));
+		inbox.clear();
+	}
+
+	void send_events()
+	{
+		for (auto&& e : extern_buffer)
+			out_event_port.fire(std::move(e));
+		extern_buffer.clear();
+	}
+
+	pure::event_sink<void> publish_tick_;
+	pure::event_sink<void> collect_tick_;
+	pure::event_sink<void> in_send_tick;
+	in_port_t in_event_port;
+	out_port_t out_event_port;
+	std::function<void()> published;
+
+	std::mutex inbox_mutex;
+	std::vector<event_t> intern_buffer;
+	/// published events, only accessed with inbox_mutex locked
+	std::vector<event_t> inbox;
+	std::vector<event_t> extern_buffer;
+};
+
+/// Template Specialization for events of type void, counts the events.
+template<>
+class event_inbox<void> final : public buffer_interface<void, event_tag>
+{
+public:
+	event_inbox()
+		: publish_tick_([this] { publish(); })
+		, collect_tick_([this] { collect(); })
+		, in_send_tick([this] { send_events(); })
+		, in_event_port([this] { ++intern_buffer; })
+	{
+	}
+
+	using out_port_t = typename pure::out_port<void, event_tag>::type;
+	using in_port_t = typename pure::in_port<void, event_tag>::type;
+
+	/// \see event_inbox::publish_tick
+	auto& publish_tick() { return publish_tick_; }
+	/// \see event_inbox::collect_tick
+	auto& collect_tick() { return collect_tick_; }
+	/// event in port of type void, fires out port once for each collected event.
+	auto& work_tick() { return in_send_tick; }
+
+	/// \see event_inbox::on_publish
+	void on_publish(std::function<void()> notify) { published = std::move(notify); }
+
+	in_port_t& in() override { return in_event_port; }
+	out_port_t& out() override { return out_event_port; }
+
+private:
+	void publish()
+	{
+		if (intern_buffer == 0)
+			return;
+		{
+			std::lock_guard<std::mutex> lock(inbox_mutex);
+			inbox += intern_buffer;
+		}
+		intern_buffer = 0;
+		if (published)
+			published();
+	}
+
+	void collect()
+	{
+		std::lock_guard<std::mutex> lock(inbox_mutex);
+		extern_buffer += inbox;
+		inbox = 0;
+	}
+
+	void send_events()
+	{
+		for (size_t i = 0; i < extern_buffer; ++i)
+			out_event_port.fire();
+		extern_buffer = 0;
+	}
+
+	pure::event_sink<void> publish_tick_;
+	pure::event_sink<void> collect_tick_;
+	pure::event_sink<void> in_send_tick;
+	in_port_t in_event_port;
+	out_port_t out_event_port;
+	std::function<void()> published;
+
+	std::mutex inbox_mutex;
+	size_t intern_buffer = 0;
+	size_t inbox = 0;
+	size_t extern_buffer = 0;
+};
+
+namespace detail
+{
+/// smallest power of two, which is at least capacity and larger than one
+inline size_t ring_capacity(size_t capacity)
+{
+	size_t result = 2;
+	while (result < capacity)
+		result *= 2;
+	return result;
+}
+}
+
+/**
+ * \brief buffer for events on a lock-free ring of fixed capacity.
+ *
+ * Events are moved into the ring as soon as the producer fires them
+ * and are sent at out on the next work tick of the consumer, no switch tick is needed.
+ * Producer and consumer may run concurrently, each slot carries a sequence number
+ * like the slots of thread::detail::injection_queue.
+ * The memory of the buffer is bounded by its capacity, events which don't fit are handled
+ * according to the overflow policy and counted by dropped.
+ * With ring_overflow::drop_oldest the new event is dropped instead,
+ * if the consumer is just taking the oldest event out of a full ring.
+ * A work tick sends at most capacity events, later events wait for the next work tick.
+ * \tparam event_t type of events, needs to be move constructible.
+ * \see event_ring_config
+ */
+template<class event_t>
+class ring_event_buffer final : public buffer_interface<event_t, event_tag>
+{
+public:
+	explicit ring_event_buffer(event_ring_config config = {})
+		: in_send_tick([this] { send_events(); })
+		, in_event_port([this](event_t in_event) { push(std::move(in_event)); })
+		, overflow(config.overflow)
+		, mask(detail::ring_capacity(config.capacity) - 1)
+		, cells(std::make_unique<cell[]>(mask + 1))
+	{
+		for (size_t i = 0; i <= mask; ++i)
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	~ring_event_buffer() override
+	{
+		while (pop([](event_t&&) {}))
+			;
+	}
+
+	using out_port_t = typename pure::out_port<event_t, event_tag>::type;
+	using in_port_t = typename pure::in_port<event_t, event_tag>::type;
+
+	/// event in port of type void, fires the events in the ring
+	auto& work_tick() { return in_send_tick; }
+	/**
+	 * \brief event out port, which sends the number of events lost since the last report.
+	 * Fired on the work tick after the events, only with ring_overflow::report.
+	 */
+	pure::event_source<size_t>& overflows() { return overflow_port; }
+	/// sets a function, which is called by the producer whenever an event has been added.
+	void on_push(std::function<void()> notify) { pushed = std::move(notify); }
+
+	in_port_t& in() override { return in_event_port; }
+	out_port_t& out() override { return out_event_port; }
+
+	/// maximum number of events in the ring
+	size_t capacity() const { return mask + 1; }
+	/// number of events dropped so far, since they did not fit into the ring.
+	size_t dropped() const { return dropped_events.load(std::memory_order_relaxed); }
+
+private:
+	/// called by the producer only
+	void push(event_t&& event)
+	{
+		bool added = try_push(event);
+		if (!added && overflow == ring_overflow::drop_oldest)
+		{
+			if (pop([](event_t&&) {}))
+				dropped_events.fetch_add(1, std::memory_order_relaxed);
+			added = try_push(event);
+		}
+		if (!added)
+		{
+			dropped_events.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		if (pushed)
+			pushed();
+	}
+
+	/// \return false if the ring is full, event is only moved from if it has been added.
+	bool try_push(event_t& event)
+	{
+		cell& c = cells[tail & mask];
+		if (c.sequence.load(std::memory_order_acquire) != tail)
+			return false;
+		new (&c.storage) event_t(std::move(event));
+		c.sequence.store(tail + 1, std::memory_order_release);
+		++tail;
+		return true;
+	}
+
+	/**
+	 * \brief takes the oldest event out of the ring and hands it to handle.
+	 * Called by the consumer and by the producer to drop the oldest event.
+	 * \return false if the ring is empty.
+	 */
+	template<class handler_t>
+	bool pop(handler_t&& handle)
+	{
+		size_t pos = head.load(std::memory_order_relaxed);
+		cell* c = nullptr;
+		while (true)
+		{
+			c = &cells[pos & mask];
+			const size_t seq = c->sequence.load(std::memory_order_acquire);
+			const auto diff =
+					static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+			if (diff == 0)
+			{
+				if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+				return false;
+			else
+				pos = head.load(std::memory_order_relaxed);
+		}
+		event_t& stored = *reinterpret_cast<event_t*>(&c->storage);
+		event_t event(std::move(stored));
+		stored.~event_t();
+		// the slot is free again before the event is handled
+		c->sequence.store(pos + mask + 1, std::memory_order_release);
+		handle(std::move(event));
+		return true;
+	}
+
+	void send_events()
+	{
+		for (size_t i = 0; i <= mask; ++i)
+		{
+			if (!pop([this](event_t&& e) { out_event_port.fire(std::move(e)); }))
+				break;
+		}
+		if (overflow != ring_overflow::report)
+			return;
+		const size_t lost = dropped() - reported;
+		if (lost == 0)
+			return;
+		reported += lost;
+		overflow_port.fire(lost);
+	}
+
+	struct cell
+	{
+		std::atomic<size_t> sequence;
+		std::aligned_storage_t<sizeof(event_t), alignof(event_t)> storage;
+	};
+
+	static constexpr size_t cache_line = 64;
+
+	pure::event_sink<void> in_send_tick;
+	in_port_t in_event_port;
+	out_port_t out_event_port;
+	pure::event_source<size_t> overflow_port;
+	std::function<void()> pushed;
+
+	const ring_overflow overflow;
+	const size_t mask;
+	std::unique_ptr<cell[]> cells;
+	/// number of dropped events already sent at overflows, only accessed by the consumer
+	size_t reported = 0;
+	// padding keeps producer and consumer from sharing a cache line
+	char pad_0[cache_line];
+	/// position of the next event to be added, only accessed by the producer
+	size_t tail = 0;
+	std::atomic<size_t> dropped_events{0};
+	char pad_1[cache_line];
+	std::atomic<size_t> head{0};
+	char pad_2[cache_line];
+};
+
+/// Template Specialization for events of type void, counts the events in the ring.
+template<>
+class ring_event_buffer<void> final : public buffer_interface<void, event_tag>
+{
+public:
+	explicit ring_event_buffer(event_ring_config config = {})
+		: in_send_tick([this] { send_events(); })
+		, in_event_port([this] { push(); })
+		, overflow(config.overflow)
+		, capacity_(detail::ring_capacity(config.capacity))
+	{
+	}
+
+	using out_port_t = typename pure::out_port<void, event_tag>::type;
+	using in_port_t = typename pure::in_port<void, event_tag>::type;
+
+	/// event in port of type void, fires out port once for each event in the ring.
+	auto& work_tick() { return in_send_tick; }
+	/// \see ring_event_buffer::overflows
+	pure::event_source<size_t>& overflows() { return overflow_port; }
+	/// \see ring_event_buffer::on_push
+	void on_push(std::function<void()> notify) { pushed = std::move(notify); }
+
+	in_port_t& in() override { return in_event_port; }
+	out_port_t& out() override { return out_event_port; }
+
+	/// \see ring_event_buffer::capacity
+	size_t capacity() const { return capacity_; }
+	/// \see ring_event_buffer::dropped
+	size_t dropped() const { return dropped_events.load(std::memory_order_relaxed); }
+
+private:
+	void push()
+	{
+		// only the producer increases the count, thus it can't exceed the capacity
+		if (pending.load(std::memory_order_relaxed) == capacity_)
+		{
+			dropped_events.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		pending.fetch_add(1, std::memory_order_release);
+		if (pushed)
+			pushed();
+	}
+
+	void send_events()
+	{
+		const size_t events = pending.exchange(0, std::memory_order_acquire);
+		for (size_t i = 0; i < events; ++i)
+			out_event_port.fire();
+		if (overflow != ring_overflow::report)
+			return;
+		const size_t lost = dropped() - reported;
+		if (lost == 0)
+			return;
+		reported += lost;
+		overflow_port.fire(lost);
+	}
+
+	pure::event_sink<void> in_send_tick;
+	in_port_t in_event_port;
+	out_port_t out_event_port;
+	pure::event_source<size_t> overflow_port;
+	std::function<void()> pushed;
+
+	const ring_overflow overflow;
+	const size_t capacity_;
+	size_t reported = 0;
+	std::atomic<size_t> pending{0};
+	std::atomic<size_t> dropped_events{0};
+};
+
+/**
+ * \brief buffer for states between regions which don't run in lockstep.
+ *
+ * The state is pulled when the producer is done with its work (publish_tick)
+ * and becomes visible to the consumer on its next collect_tick.
+ * \see event_inbox
+ * \tparam data_t type of state stored in buffer. needs to be copy_constructable.
+ */
+template<class data_t>
+class state_inbox final : public buffer_interface<data_t, state_tag>
+{
+public:
+	state_inbox()
+		: publish_tick_([this] { publish(); })
+		, collect_tick_([this] { collect(); })
+		, out_port([this] { return extern_buffer; })
+	{
+	}
+
+	/// event in port of type void, pulls the state and makes it available to the consumer
+	auto& publish_tick() { return publish_tick_; }
+	/// event in port of type void, takes the most recently published state
+	auto& collect_tick() { return collect_tick_; }
+
+	pure::state_sink<data_t>& in() override { return in_port; }
+	pure::state_source<data_t>& out() override { return out_port; }
+
+private:
+	void publish()
+	{
+		data_t current = in_port.get();
+		std::lock_guard<std::mutex> lock(inbox_mutex);
+		inbox = std::move(current);
+		fresh = true;
+	}
+
+	void collect()
+	{
+		std::lock_guard<std::mutex> lock(inbox_mutex);
+		if (!fresh)
+			return;
+		std::swap(extern_buffer, inbox);
+		fresh = false;
+	}
+
+	pure::event_sink<void> publish_tick_;
+	pure::event_sink<void> collect_tick_;
+	pure::state_sink<data_t> in_port;
+	pure::state_source<data_t> out_port;
+
+	std::mutex inbox_mutex;
+	/// most recently published state, only accessed with inbox_mutex locked
+	data_t inbox{};
+	/// true if inbox has been published but not collected
+	bool fresh = false;
+	data_t extern_buffer{};
+};
+
 namespace detail
 {
 template<class data_t, class tag>
@@ -386,10 +1230,30 @@ struct buffer<data_t, event_tag>
 	using type = event_buffer<data_t>;
 };
 
+/// size above which states are swapped by triple_state_buffer instead of being copied
+constexpr size_t large_state_size = 64;
+
 template<class data_t>
 struct buffer<data_t, state_tag>
 {
-	using type = state_buffer<data_t>;
+	using type = std::conditional_t<sizeof(data_t) <= large_state_size
+			&& std::is_trivially_copyable<data_t>{},
+			state_buffer<data_t>, triple_state_buffer<data_t>>;
+};
+
+template<class data_t, class tag>
+struct inbox {};
+
+template<class data_t>
+struct inbox<data_t, event_tag>
+{
+	using type = event_inbox<data_t>;
+};
+
+template<class data_t>
+struct inbox<data_t, state_tag>
+{
+	using type = state_inbox<data_t>;
 };
 }
 
@@ -400,10 +1264,24 @@ template<class T>
 inline fc::state_buffer<T>::state_buffer() :
 		switch_active_tick_([this] { switch_active_buffers(); }),
 		switch_passive_tick_([this] { switch_passive_buffers(); }),
-		switch_active_passive_tick_([this] { switch_active_passive_buffers(); }),
-		in_work_tick([this]() { intern_buffer = in_port.get(); }),
+		switch_active_passive_tick_([this]
+				{
+					if (!handing_off())
+						switch_active_passive_buffers();
+				}),
+		handoff_tick_([this]
+				{
+					if (handing_off())
+						extern_buffer = in_port.get();
+				}),
+		in_work_tick([this]()
+				{
+					if (!handing_off())
+						intern_buffer = in_port.get();
+				}),
 		in_port(),
 		out_port([this](){ return extern_buffer; }),
+		handoff_condition(),
 		intern_buffer(), //todo, forces T to be default constructible, we should lift that restriction.
 		extern_buffer(),
 		middle_buffer()
@@ -0,0 +1,33 @@
+#ifndef SRC_PORTS_EVENT_RING_CONFIG_HPP_
+#define SRC_PORTS_EVENT_RING_CONFIG_HPP_
+
+#include <cstddef>
+
+namespace fc
+{
+
+/// what ring_event_buffer does with events which don't fit into the ring anymore.
+enum class ring_overflow
+{
+	/// the oldest event in the ring is dropped to make room for the new one.
+	drop_oldest,
+	/// the new event is dropped, the events in the ring are kept.
+	drop_newest,
+	/// the new event is dropped and the number of lost events is sent on the next work tick.
+	report
+};
+
+/**
+ * \brief configuration of a ring_event_buffer.
+ * \see parallel_region::send_events_through_ring, node_aware::send_events_through_ring
+ */
+struct event_ring_config
+{
+	/// maximum number of events in the ring, rounded up to a power of two.
+	size_t capacity = 1024;
+	ring_overflow overflow = ring_overflow::drop_newest;
+};
+
+} // namespace fc
+
+#endif /* SRC_PORTS_EVENT_RING_CONFIG_HPP_ */
@@ -7,7 +7,14 @@
 #include "extended/ports/connection_buffer.hpp"
 #include "scheduler/parallelregion.hpp"
 
+#include <cassert>
 #include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace fc
 {
@@ -40,8 +47,17 @@ struct buffer_factory
 	/**
 	 * \brief Creates buffer or no_buffer depending on regions of active and passive
 	 * \returns either buffer if the regions differ and no_buffer if they are from the same region.
+	 * Events pass through a coalescing_event_buffer, if the event source keeps only the latest
+	 * events (see node_aware::keep_latest_event_per_key), or through a ring_event_buffer,
+	 * if a ring is set on the event source or for the pair of regions
+	 * (see parallel_region::send_events_through_ring).
+	 * Otherwise, if either region is event triggered (see parallel_region::trigger_on_events),
+	 * the buffer is an inbox, which hands data over once the producer is done with its work.
+	 * node_aware ports share a single buffer for all their connections to the same region.
 	 * \param active active port of the connection
 	 * \param passive passive port of the connection
+	 * \throws std::invalid_argument if latest events are kept for a connection
+	 * to or from an event triggered region.
 	 */
 	template<class active_t, class passive_t, class tag>
 	static auto construct_buffer(const active_t& active,
@@ -49,26 +65,151 @@ struct buffer_factory
 			-> std::shared_ptr<buffer_interface<token_t, tag>>
 	{
 		if (!same_region(active, passive))
+		{
+			if (auto coalescing_buffer = construct_coalescing(active, passive, tag{}))
+				return coalescing_buffer;
+			if (auto ring_buffer = construct_ring(active, passive, tag{}))
+				return ring_buffer;
+		}
+		if (!same_region(active, passive) && (active.region().is_event_triggered()
+				|| passive.region().is_event_triggered()))
+		{
+			auto result_buffer =
+					std::make_shared<typename detail::inbox<token_t, tag>::type>();
+			parallel_region& producer = producing_region(active.region(), passive.region(), tag{});
+			parallel_region& consumer = consuming_region(active.region(), passive.region(), tag{});
+			producer.work_done() >> result_buffer->publish_tick();
+			consumer.switch_tick() >> result_buffer->collect_tick();
+			connect_inbox(*result_buffer, consumer, tag{});
+			return result_buffer;
+		}
+		else if (!same_region(active, passive))
 		{
 			auto result_buffer =
 					std::make_shared<typename detail::buffer<token_t, tag>::type>();
-
-			if(same_tick_rate(active, passive))
-			{
-				active.region().switch_tick() >> result_buffer->switch_active_passive_tick();
-			}
-			else
-			{
-				active.region().switch_tick() >> result_buffer->switch_active_tick();
-				passive.region().switch_tick() >> result_buffer->switch_passive_tick();
-			}
-			passive.region().work_tick() >> result_buffer->work_tick();
-
+			connect_double_buffer(*result_buffer, active.region(), passive.region(), tag{});
 			return result_buffer;
 		}
 		else
 			return std::make_shared<typename detail::no_buffer<token_t, tag>::type>();
 	}
+
+	/**
+	 * \brief connects the ticks of a buffer like event_buffer or state_buffer to two regions.
+	 * \param active region of the active port of the connection
+	 * \param passive region of the passive port of the connection
+	 */
+	template<class buffer_t, class tag>
+	static void connect_double_buffer(buffer_t& buffer,
+			parallel_region& active, parallel_region& passive, tag)
+	{
+		if (active.get_duration() == passive.get_duration())
+		{
+			active.switch_tick() >> buffer.switch_active_passive_tick();
+
+			// if the regions are ordered by their dependencies,
+			// data is handed to the consumer as soon as the producer is done.
+			parallel_region& producer = producing_region(active, passive, tag{});
+			parallel_region& consumer = consuming_region(active, passive, tag{});
+			producer.work_done() >> buffer.handoff_tick();
+			buffer.hand_off_if([&producer, &consumer]
+			{
+				return consumer.receives_handoff_from(producer);
+			});
+		}
+		else
+		{
+			active.switch_tick() >> buffer.switch_active_tick();
+			passive.switch_tick() >> buffer.switch_passive_tick();
+		}
+		passive.work_tick() >> buffer.work_tick();
+	}
+
+private:
+	/**
+	 * \brief creates a coalescing_event_buffer, if the event source keeps only the latest events.
+	 * \returns nullptr if all events are buffered.
+	 */
+	template<class active_t, class passive_t>
+	static std::shared_ptr<buffer_interface<token_t, event_tag>> construct_coalescing(
+			const active_t& active, const passive_t& passive, event_tag)
+	{
+		if (!active.keeps_latest_events())
+			return nullptr;
+		if (active.region().is_event_triggered() || passive.region().is_event_triggered())
+			throw std::invalid_argument("latest events can't be kept for connections "
+					"of event triggered region " + (active.region().is_event_triggered()
+					? active.region().get_id().key : passive.region().get_id().key));
+		return active.template construct_coalescing_buffer<token_t>(passive.region());
+	}
+	/// states are never coalesced, a state buffer always holds the latest state only.
+	template<class active_t, class passive_t>
+	static std::shared_ptr<buffer_interface<token_t, state_tag>> construct_coalescing(
+			const active_t&, const passive_t&, state_tag)
+	{
+		return nullptr;
+	}
+
+	/**
+	 * \brief creates a ring_event_buffer, if a ring is set for the connection.
+	 * The setting of the event source takes precedence over the one of the regions.
+	 * \returns nullptr if events are not sent through a ring.
+	 */
+	template<class active_t, class passive_t>
+	static std::shared_ptr<buffer_interface<token_t, event_tag>> construct_ring(
+			const active_t& active, const passive_t& passive, event_tag)
+	{
+		const event_ring_config* config = active.event_ring();
+		if (!config)
+			config = active.region().event_ring_to(passive.region());
+		if (!config)
+			return nullptr;
+
+		auto result_buffer = std::make_shared<ring_event_buffer<token_t>>(*config);
+		parallel_region& consumer = passive.region();
+		consumer.work_tick() >> result_buffer->work_tick();
+		if (consumer.is_event_triggered())
+			result_buffer->on_push([&consumer] { consumer.data_arrived(); });
+		return result_buffer;
+	}
+	/// states are never sent through rings
+	template<class active_t, class passive_t>
+	static std::shared_ptr<buffer_interface<token_t, state_tag>> construct_ring(
+			const active_t&, const passive_t&, state_tag)
+	{
+		return nullptr;
+	}
+
+	/// events are sent on the work tick of the consumer and wake it if it is triggered by them.
+	template<class inbox_t>
+	static void connect_inbox(inbox_t& inbox, parallel_region& consumer, event_tag)
+	{
+		consumer.work_tick() >> inbox.work_tick();
+		if (consumer.is_event_triggered())
+			inbox.on_publish([&consumer] { consumer.data_arrived(); });
+	}
+	/// states are pulled by the consumer, changing states don't trigger it.
+	template<class inbox_t>
+	static void connect_inbox(inbox_t&, parallel_region&, state_tag)
+	{
+	}
+
+	/// events are produced by the active side of a connection
+	static parallel_region& producing_region(parallel_region& active, parallel_region&, event_tag)
+	{
+		return active;
+	}
+	/// states are produced by the passive side of a connection
+	static parallel_region& producing_region(parallel_region&, parallel_region& passive, state_tag)
+	{
+		return passive;
+	}
+	/// the consumer is always the side, which is not the producer
+	template<class tag>
+	static parallel_region& consuming_region(parallel_region& active, parallel_region& passive, tag)
+	{
+		return producing_region(passive, active, tag{});
+	}
 };
 
 /**
@@ -132,6 +273,36 @@ private:
 	std::shared_ptr<buffer_interface<result_t, state_tag>> buffer;
 };
 
+/**
+ * \brief port_connection returned when a node_aware event source is connected through a buffer.
+ *
+ * The buffer is shared by all connections of the source to the same region,
+ * every connection co-owns it, not only the first one, which sends the events into it.
+ * \tparam base_connection port_connection type of the connection.
+ * \invariant buffer != null_ptr
+ */
+template<class base_connection>
+struct buffer_owning_connection: base_connection
+{
+	using result_t = typename base_connection::result_t;
+
+	explicit buffer_owning_connection(std::shared_ptr<
+			buffer_interface<result_t, event_tag>> new_buffer) :
+			base_connection(), buffer(std::move(new_buffer))
+	{
+		assert(buffer);
+	}
+
+	/// buffer the events pass through on their way to the sink.
+	const std::shared_ptr<buffer_interface<result_t, event_tag>>& get_buffer() const
+	{
+		return buffer;
+	}
+
+private:
+	std::shared_ptr<buffer_interface<result_t, event_tag>> buffer;
+};
+
 ///node_aware ports inherit these properties from their base
 template<class T> struct is_active_sink<node_aware<T>> : is_active_sink<T> {};
 template<class T> struct is_active_source<node_aware<T>> : is_active_source<T> {};
@@ -232,6 +403,70 @@ struct node_aware: base
 	///returns reference to parallel_region this mixin is associated with.
 	parallel_region& region() const { return region_; }
 
+	/**
+	 * \brief lets connections made afterwards from this port to other regions
+	 * pass events through a ring_event_buffer, regardless of the setting of the regions.
+	 * Regions already connected to the port keep their buffer, as it is shared by all
+	 * connections to the region.
+	 * \see parallel_region::send_events_through_ring
+	 */
+	template<class T = base, class enable = std::enable_if_t<is_active_source<T>{}>>
+	void send_events_through_ring(event_ring_config config = {})
+	{
+		ring = std::make_shared<const event_ring_config>(config);
+	}
+	/// ring set by send_events_through_ring, nullptr if none is set.
+	const event_ring_config* event_ring() const { return ring.get(); }
+
+	/**
+	 * \brief lets connections made afterwards from this port to other regions
+	 * keep only the latest event for every key, see coalescing_event_buffer.
+	 * Takes precedence over a ring set with send_events_through_ring.
+	 * \param key_of extracts the key of an event, called once for every event.
+	 * \pre the port is not connected to event triggered regions.
+	 */
+	template<class key_extractor,
+			class T = base,
+			class enable = std::enable_if_t<is_active_source<T>{}>>
+	void keep_latest_event_per_key(key_extractor key_of)
+	{
+		using event_t = result_of_t<base>;
+		using key_t = std::decay_t<decltype(key_of(std::declval<const event_t&>()))>;
+		static_assert(!std::is_void<event_t>{}, "void events can't be coalesced.");
+		coalescing_factory = [key_of](parallel_region& producer, parallel_region& consumer)
+		{
+			auto buffer = std::make_shared<coalescing_event_buffer<event_t, key_t>>(key_of);
+			buffer_factory<event_t>::connect_double_buffer(*buffer, producer, consumer,
+					event_tag());
+			return std::shared_ptr<void>(
+					std::shared_ptr<buffer_interface<event_t, event_tag>>(std::move(buffer)));
+		};
+	}
+	/**
+	 * \brief lets connections made afterwards from this port to other regions
+	 * keep only the latest event.
+	 * \see keep_latest_event_per_key
+	 */
+	template<class T = base, class enable = std::enable_if_t<is_active_source<T>{}>>
+	void keep_latest_event()
+	{
+		keep_latest_event_per_key([](const result_of_t<base>&) { return true; });
+	}
+	/// true if keep_latest_event_per_key or keep_latest_event has been called.
+	bool keeps_latest_events() const { return static_cast<bool>(coalescing_factory); }
+	/**
+	 * \brief creates the coalescing_event_buffer for a connection to consumer.
+	 * \pre keeps_latest_events()
+	 */
+	template<class token_t>
+	std::shared_ptr<buffer_interface<token_t, event_tag>> construct_coalescing_buffer(
+			parallel_region& consumer) const
+	{
+		assert(keeps_latest_events());
+		return std::static_pointer_cast<buffer_interface<token_t, event_tag>>(
+				coalescing_factory(region(), consumer));
+	}
+
 private:
 	// helper aliases to make method prototypes easier to read.
 	using connection_has_node_aware = std::true_type;
@@ -240,12 +475,23 @@ private:
 	using base_is_sink = std::false_type;
 
 	std::reference_wrapper<parallel_region> region_;
+	std::shared_ptr<const event_ring_config> ring;
+	/// creates buffers of keep_latest_event_per_key for a producing and a consuming region.
+	std::function<std::shared_ptr<void>(parallel_region&, parallel_region&)> coalescing_factory;
+	/**
+	 * \brief buffers of connections from this port to other regions, by region.
+	 * Regions are told apart by identity, regions with equal ids don't share buffers.
+	 * Filled on connect, thus mutable, as state sources are passed as const to their sinks.
+	 */
+	mutable std::vector<std::pair<const parallel_region*, std::weak_ptr<void>>> shared_buffers;
+
+	/// state sinks share the buffers of the state sources they are connected to.
+	template <class> friend struct node_aware;
 
 	template <class conn_t>
 	auto connect_impl(conn_t&& conn, connection_has_node_aware)
 	{
-		return base::connect(
-		    introduce_buffer(std::forward<conn_t>(conn), is_active_source<base>{}));
+		return connect_buffered(std::forward<conn_t>(conn), is_active_source<base>{});
 	}
 
 	template <class conn_t>
@@ -254,28 +500,95 @@ private:
 		return base::connect(std::forward<conn_t>(conn));
 	}
 
+	/**
+	 * \brief connects the event source through a buffer shared by all its sinks in a region.
+	 *
+	 * Only the first connection to a region sends the events of the source into the buffer,
+	 * later connections are only connected to the output of the buffer.
+	 * \returns buffer_owning_connection, which co-owns the buffer of the connection.
+	 */
 	template <class conn_t>
-	auto introduce_buffer(conn_t&& conn, base_is_source)
+	auto connect_buffered(conn_t&& conn, base_is_source)
 	{
 		using result_t = result_of_t<base_t>;
+		using buffer_t = buffer_interface<result_t, event_tag>;
 		const auto& sink = get_sink(conn);
-		return detail::make_buffered_connection(
-				buffer_factory<result_t>::construct_buffer(
-						*this,  // event source is active, thus first
-						sink,  // event sink is passive thus second
-						event_tag()), *this, std::forward<conn_t>(conn));
+		auto buffer = shared_buffer<buffer_t>(sink.region());
+		const bool buffer_is_shared = buffer != nullptr;
+		if (!buffer_is_shared)
+		{
+			buffer = buffer_factory<result_t>::construct_buffer(
+					*this,  // event source is active, thus first
+					sink,  // event sink is passive thus second
+					event_tag());
+			if (!same_region(*this, sink))
+				share_buffer(sink.region(), buffer);
+		}
+		auto buffered = detail::make_buffered_connection(
+				buffer, *this, std::forward<conn_t>(conn));
+		using port_connection_t = decltype(base::connect(std::move(buffered)));
+		// the source already sends its events into the shared buffer
+		if (!buffer_is_shared)
+			base::connect(std::move(buffered));
+		return buffer_owning_connection<port_connection_t>(std::move(buffer));
 	}
 
+	/**
+	 * \brief connects the state sink through a buffer shared by all sinks of the source in a region.
+	 *
+	 * Buffers are only shared by sinks connected directly to the source,
+	 * as connectables in between might change the state.
+	 */
 	template <class conn_t>
-	auto introduce_buffer(conn_t&& conn, base_is_sink)
+	auto connect_buffered(conn_t&& conn, base_is_sink)
 	{
 		using result_t = result_of_t<conn_t>;
+		using buffer_t = buffer_interface<result_t, state_tag>;
 		const auto& source = get_source(conn);
-		return detail::make_buffered_connection(
-				buffer_factory<result_t>::construct_buffer(
-						*this,  // state sink is active thus first
-						source,  // state source is passive thus second
-						state_tag()), std::forward<conn_t>(conn), *this);
+		const bool direct = std::is_same<std::decay_t<conn_t>, std::decay_t<decltype(source)>>{};
+		std::shared_ptr<buffer_t> buffer{};
+		if (direct)
+			buffer = source.template shared_buffer<buffer_t>(region());
+		if (!buffer)
+		{
+			buffer = buffer_factory<result_t>::construct_buffer(
+					*this,  // state sink is active thus first
+					source,  // state source is passive thus second
+					state_tag());
+			if (direct && !same_region(source, *this))
+				source.share_buffer(region(), buffer);
+		}
+		return base::connect(detail::make_buffered_connection(
+				std::move(buffer), std::forward<conn_t>(conn), *this));
+	}
+
+	/**
+	 * \brief buffer of earlier connections from this port to region.
+	 * \returns nullptr if there is none or if it has been destroyed.
+	 */
+	template <class buffer_t>
+	std::shared_ptr<buffer_t> shared_buffer(const parallel_region& region) const
+	{
+		for (const auto& shared : shared_buffers)
+		{
+			if (shared.first == &region)
+				return std::static_pointer_cast<buffer_t>(shared.second.lock());
+		}
+		return nullptr;
+	}
+
+	/// lets later connections from this port to region use buffer.
+	void share_buffer(const parallel_region& region, std::shared_ptr<void> buffer) const
+	{
+		for (auto& shared : shared_buffers)
+		{
+			if (shared.first == &region)
+			{
+				shared.second = buffer;
+				return;
+			}
+		}
+		shared_buffers.emplace_back(&region, buffer);
 	}
 
 	template <class conn_t>
@@ -1,8 +1,10 @@
 #include "infrastructure.hpp"
 #include "scheduler/parallelscheduler.hpp"
 
+#include <algorithm>
 #include <memory>
 #include <stdexcept>
+#include <string>
 
 namespace fc
 {
@@ -11,15 +13,19 @@ class scheduled_region : public fc::parallel_region
 {
 public:
 	scheduled_region(std::string name, virtual_clock::steady::duration tick_rate,
-			std::weak_ptr<region_factory> region_maker)
-		: parallel_region(std::move(name), tick_rate), region_maker(std::move(region_maker))
+			std::weak_ptr<region_factory> region_maker, int worker_group)
+		: parallel_region(std::move(name), tick_rate)
+		, region_maker(std::move(region_maker))
+		, worker_group(worker_group)
 	{
 	}
+	/// new regions are executed by the same worker group as this region.
 	std::shared_ptr<parallel_region>
 	new_region(std::string name, virtual_clock::steady::duration tick_rate) const override;
 
 private:
 	std::weak_ptr<region_factory> region_maker;
+	int worker_group;
 };
 
 /** \brief Factory for creating regions and connecting them to the scheduler
@@ -31,9 +37,16 @@ class region_factory : public std::enable_shared_from_this<region_factory>
 public:
 	explicit region_factory(thread::cycle_control& scheduler) : scheduler(scheduler) {}
 
-	/// Creates a new region and connects it to the scheduler with a periodic task.
+	/**
+	 * \brief Creates a new region and connects it to the scheduler with a periodic task.
+	 * \param worker_group group of worker threads which executes the region.
+	 */
 	std::shared_ptr<parallel_region> new_region(const std::string& name,
-	                                            const virtual_clock::steady::duration& tick_rate);
+	                                            const virtual_clock::steady::duration& tick_rate,
+	                                            int worker_group = thread::any_worker_group);
+	/// Creates a new event triggered region and connects it to the scheduler.
+	std::shared_ptr<parallel_region> new_triggered_region(const std::string& name,
+			wall_clock::steady::duration min_interval);
 
 private:
 	thread::cycle_control& scheduler;
@@ -43,20 +56,34 @@ std::shared_ptr<parallel_region>
 scheduled_region::new_region(std::string name, virtual_clock::steady::duration tick_rate) const
 {
 	if (auto factory = region_maker.lock())
-		return factory->new_region(std::move(name), tick_rate);
+		return factory->new_region(std::move(name), tick_rate, worker_group);
 	else
 		throw std::runtime_error{"Region factory has been destroyed already"};
 }
 
 std::shared_ptr<parallel_region>
 region_factory::new_region(const std::string& name,
-                           const virtual_clock::steady::duration& tick_rate)
+                           const virtual_clock::steady::duration& tick_rate,
+                           int worker_group)
 {
-	auto region = std::make_shared<scheduled_region>(name, tick_rate, shared_from_this());
-	auto tick_cycle = fc::thread::periodic_task(region);
+	auto region = std::make_shared<scheduled_region>(
+			name, tick_rate, shared_from_this(), worker_group);
+	auto tick_cycle = fc::thread::periodic_task(region, worker_group);
 	scheduler.add_task(std::move(tick_cycle),tick_rate);
 	return region;
 }
+
+std::shared_ptr<parallel_region>
+region_factory::new_triggered_region(const std::string& name,
+		wall_clock::steady::duration min_interval)
+{
+	auto region = std::make_shared<scheduled_region>(name,
+			std::chrono::duration_cast<virtual_clock::steady::duration>(min_interval),
+			shared_from_this(), thread::any_worker_group);
+	region->trigger_on_events(min_interval);
+	scheduler.add_triggered_task(fc::thread::periodic_task(region));
+	return region;
+}
 } // namespace detail
 
 std::shared_ptr<parallel_region>
@@ -66,11 +93,49 @@ infrastructure::add_region(const std::string& name,
 	return region_maker->new_region(name, tick_rate);
 }
 
-infrastructure::infrastructure()
-    : scheduler(std::make_unique<fc::thread::parallel_scheduler>())
+std::shared_ptr<parallel_region>
+infrastructure::add_region(const std::string& name,
+                           const virtual_clock::steady::duration& tick_rate,
+                           int worker_group)
+{
+	if (worker_group < 0 || worker_group >= workers.nr_of_groups())
+		throw std::invalid_argument{"unknown worker group " + std::to_string(worker_group)};
+	return region_maker->new_region(name, tick_rate, worker_group);
+}
+
+std::shared_ptr<parallel_region>
+infrastructure::add_triggered_region(const std::string& name,
+		wall_clock::steady::duration min_interval)
+{
+	return region_maker->new_triggered_region(name, min_interval);
+}
+
+namespace
+{
+/// largest multiple of base_tick not above medium_tick, used as tick rate of the root region.
+virtual_clock::steady::duration root_tick(virtual_clock::steady::duration base_tick)
+{
+	const auto medium_tick = thread::cycle_control::medium_tick;
+	return std::max(base_tick, medium_tick - medium_tick % base_tick);
+}
+}
+
+infrastructure::infrastructure(virtual_clock::steady::duration base_tick)
+    : infrastructure(thread::scheduler_config{}, base_tick)
+{
+}
+
+infrastructure::infrastructure(const thread::scheduler_config& config,
+		virtual_clock::steady::duration base_tick)
+    : own_clock()
+    , workers(config.workers.empty()
+            ? thread::scheduler_config::with_threads(thread::parallel_scheduler::num_threads())
+            : config)
+    , scheduler(std::make_unique<fc::thread::parallel_scheduler>(workers),
+            std::make_shared<thread::realtime_main_loop>(), base_tick)
     , region_maker(std::make_shared<detail::region_factory>(scheduler))
     , graph()
-    , forest_root(graph, "root", add_region("root_region", thread::cycle_control::medium_tick))
+    , forest_root(graph, "root", add_region("root_region", root_tick(base_tick)))
 {
 }
 
@@ -79,22 +144,58 @@ infrastructure::~infrastructure()
 	stop_scheduler();
 }
 
-void infrastructure::iterate_main_loop()
+void infrastructure::assign_waves()
+{
+	for (const auto& region : fc::graph::region_waves(graph))
+		region.first->wave = dependency_order ? region.second : parallel_region::unordered;
+}
+
+void infrastructure::start_scheduler()
+{
+	assign_waves();
+	scheduler.start();
+	scheduler_started = true;
+}
+
+void infrastructure::use_own_clock()
+{
+	if (!own_clock)
+		own_clock = std::make_unique<virtual_clock::context>();
+	scheduler.set_clock_context(*own_clock);
+}
+
+bool infrastructure::iterate_main_loop(wall_clock::steady::duration timeout)
 {
-	using namespace std::chrono_literals;
-	std::this_thread::sleep_for(0.5s);
+	const bool running = scheduler.wait_for_exception_until(wall_clock::steady::now() + timeout);
 	if (auto ex = scheduler.last_exception())
 	{
 		std::rethrow_exception(ex);
 	}
+	return running;
 }
 
 void infrastructure::infinite_main_loop()
 {
-	while( true )
+	if (!scheduler_started)
+		throw std::logic_error{"infinite_main_loop called before start_scheduler"};
+	while (iterate_main_loop())
 	{
-		iterate_main_loop();
 	}
 }
 
+void infrastructure::run_until(const std::function<bool(void)>& done)
+{
+	assign_waves();
+	scheduler.run_until(done);
+	if (auto ex = scheduler.last_exception())
+	{
+		std::rethrow_exception(ex);
+	}
+}
+
+void infrastructure::run_until(virtual_clock::steady::time_point time)
+{
+	run_until([time] { return virtual_clock::steady::now() >= time; });
+}
+
 } /* namespace fc */
@@ -3,6 +3,10 @@
 
 #include "extended/base_node.hpp"
 #include "scheduler/cyclecontrol.hpp"
+#include "scheduler/schedulerconfig.hpp"
+
+#include <chrono>
+#include <functional>
 
 namespace fc
 {
@@ -13,25 +17,146 @@ class region_factory;
 class infrastructure
 {
 public:
-	infrastructure();
+	/**
+	 * \param base_tick duration of a single cycle of the scheduler,
+	 * tick rates of all regions need to be multiples of it.
+	 * \pre base_tick > 0
+	 */
+	explicit infrastructure(
+			virtual_clock::steady::duration base_tick = thread::cycle_control::min_tick_length);
+	/**
+	 * \param config number, cpu affinity and groups of the worker threads of the scheduler.
+	 * \param base_tick duration of a single cycle of the scheduler.
+	 * \pre base_tick > 0
+	 */
+	explicit infrastructure(const thread::scheduler_config& config,
+			virtual_clock::steady::duration base_tick = thread::cycle_control::min_tick_length);
 	~infrastructure();
 
+	/// adds a region which is executed by any worker thread.
 	std::shared_ptr<parallel_region> add_region(const std::string& name,
 			const virtual_clock::steady::duration& tick_rate);
+	/**
+	 * \brief adds a region which is only executed by the workers of worker_group.
+	 * Regions created from it with parallel_region::new_region use the same workers.
+	 * \pre worker_group is a group of the scheduler_config,
+	 * otherwise std::invalid_argument is thrown.
+	 */
+	std::shared_ptr<parallel_region> add_region(const std::string& name,
+			const virtual_clock::steady::duration& tick_rate, int worker_group);
+	/**
+	 * \brief adds a region which runs whenever events from other regions arrive.
+	 *
+	 * Runs of the region start at least min_interval apart.
+	 * \see parallel_region::trigger_on_events, thread::cycle_control::add_triggered_task
+	 * \pre min_interval > 0
+	 * \pre scheduler is not running
+	 */
+	std::shared_ptr<parallel_region> add_triggered_region(const std::string& name,
+			wall_clock::steady::duration min_interval);
 
 	owning_base_node& node_owner() { return forest_root.nodes(); }
 	graph::connection_graph& get_graph() { return graph; }
 	void visualize(std::ostream& out) { forest_root.visualize(out); }
+	/**
+	 * \brief calls iterate_main_loop until the scheduler is stopped.
+	 *
+	 * Returns once stop_scheduler has been called, e.g. by another thread.
+	 * \throws the exception of the failed task, see iterate_main_loop
+	 * \throws std::logic_error if start_scheduler has never been called,
+	 * as the loop would return right away.
+	 */
 	void infinite_main_loop();
-	void start_scheduler() { scheduler.start(); }
+	/**
+	 * \brief starts the scheduler.
+	 * If enabled by order_regions_by_dependencies, the regions in the connection graph
+	 * are ordered by their dependencies first.
+	 */
+	void start_scheduler();
+	/**
+	 * \brief enables running regions with the same tick rate in the order of their dependencies.
+	 *
+	 * If enabled, data passed from one region to a region with the same tick rate
+	 * is available to the consumer in the same cycle, instead of one cycle later.
+	 * Regions in cyclic dependencies and regions which are not in the connection graph
+	 * keep the double buffered behavior. Takes effect on the next start_scheduler.
+	 * \see graph::region_waves
+	 */
+	void order_regions_by_dependencies(bool enable = true) { dependency_order = enable; }
+	/**
+	 * \brief fuses cheap regions with the same tick rate into combined tasks.
+	 * \see thread::cycle_control::set_fusion_budget, parallel_region::declare_cost
+	 * \pre scheduler is not running
+	 */
+	void fuse_regions(wall_clock::steady::duration budget) { scheduler.set_fusion_budget(budget); }
+	/**
+	 * \brief sets how the scheduler reacts to overload.
+	 * \see thread::overrun_policy
+	 * \pre scheduler is not running
+	 */
+	void set_overrun_policy(std::unique_ptr<thread::overrun_policy> policy)
+	{
+		scheduler.set_overrun_policy(std::move(policy));
+	}
+	/**
+	 * \brief lets up to helpers worker tasks switch the buffers of regions in parallel.
+	 * \see thread::cycle_control::set_parallel_switch
+	 * \pre scheduler is not running
+	 */
+	void switch_in_parallel(size_t helpers) { scheduler.set_parallel_switch(helpers); }
 	void stop_scheduler() { scheduler.stop(); }
-	void iterate_main_loop();
+	/**
+	 * \brief lets the scheduler advance a virtual clock of its own.
+	 *
+	 * The virtual time of this infrastructure is then independent of the time of other
+	 * infrastructures in the same process, thus several simulations can run concurrently.
+	 * Within regions, virtual_clock reports this time, other threads can access it
+	 * with a virtual_clock::context::scope on clock_context().
+	 * \pre scheduler is not running
+	 */
+	void use_own_clock();
+	/// context of the virtual clock advanced by the scheduler
+	virtual_clock::context& clock_context() { return scheduler.clock_context(); }
+	/**
+	 * \brief waits until a task fails, the scheduler stops or timeout passes.
+	 *
+	 * Wakes immediately on failures and stop requests, instead of polling.
+	 * \throws the exception of the failed task, see thread::cycle_control::last_exception
+	 * \return true if the scheduler is still running after the wait, false if it has been
+	 * stopped or was never started, in which case the call returns without waiting.
+	 */
+	bool iterate_main_loop(wall_clock::steady::duration timeout = std::chrono::milliseconds(500));
+	/**
+	 * \brief runs cycles on the calling thread as fast as possible, until done returns true.
+	 *
+	 * done is checked after every cycle, once all of its work is finished,
+	 * thus tests don't depend on the wall clock.
+	 * \see thread::cycle_control::run_until
+	 * \throws the exception of a task, which has not finished in time.
+	 * \pre scheduler is not running
+	 */
+	void run_until(const std::function<bool(void)>& done);
+	/**
+	 * \brief runs cycles on the calling thread as fast as possible, until the virtual clock
+	 * of the scheduler reaches time.
+	 * \see run_until(const std::function<bool(void)>&)
+	 */
+	void run_until(virtual_clock::steady::time_point time);
 
 private:
+	/// sets the waves of the regions in the graph, see order_regions_by_dependencies
+	void assign_waves();
+
+	/// context of the virtual clock if use_own_clock was called, outlives the scheduler.
+	std::unique_ptr<virtual_clock::context> own_clock;
+	thread::scheduler_config workers;
 	thread::cycle_control scheduler;
 	std::shared_ptr<detail::region_factory> region_maker;
 	graph::connection_graph graph;
 	forest_owner forest_root;
+	bool dependency_order = false;
+	/// set by start_scheduler, stays set after the scheduler is stopped.
+	bool scheduler_started = false;
 };
 
 } /* namespace fc */
@@ -10,6 +10,7 @@
 
 #include <cassert>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace fc
@@ -40,6 +41,9 @@ struct event_source
 
 	/**
 	 * \brief Sends parameter as event to all connected conntables and event_sinks.
+	 *
+	 * Every target receives a copy of event, except for the last one,
+	 * which receives event itself if it is an rvalue.
 	 * \param event token to be sent through this port.
 	 */
 	template<class... T>
@@ -53,11 +57,18 @@ struct event_source
 				"tried to call fire with a type, not implicitly convertible to type of port."
 				"If conversion is required, do the cast before calling fire.");
 
-		for (auto& target : base.storage.handlers)
+		auto& handlers = base.storage.handlers;
+		if (handlers.empty())
+			return;
+		const size_t last = handlers.size() - 1;
+		for (size_t i = 0; i != last; ++i)
 		{
-			assert(target);
-			target(static_cast<event_t>(event)...);
+			assert(handlers[i]);
+			handlers[i](static_cast<event_t>(event)...);
 		}
+		// all other targets receive copies, so the last one may take an rvalue event.
+		assert(handlers[last]);
+		handlers[last](static_cast<event_t>(std::forward<T>(event))...);
 	}
 
 	/// Gives the number of connections from this port.
@@ -12,18 +12,37 @@ namespace fc
 
 namespace chr = std::chrono;
 
-std::atomic<virtual_clock::system::time_point>
-		virtual_clock::system::current_time{(
-				virtual_clock::system::time_point(
-						virtual_clock::system::duration::zero()))};
-std::atomic<virtual_clock::steady::time_point>
-		virtual_clock::steady::current_time{(
-				virtual_clock::steady::time_point(
-						virtual_clock::steady::duration::zero()))};
+namespace
+{
+/// context activated by the innermost scope in this thread, nullptr for the default
+thread_local virtual_clock::context* active_context = nullptr;
+}
+
+virtual_clock::context& virtual_clock::context::process_default() noexcept
+{
+	static context default_context;
+	return default_context;
+}
+
+virtual_clock::context& virtual_clock::context::current() noexcept
+{
+	return active_context ? *active_context : process_default();
+}
+
+virtual_clock::context::scope::scope(context& active) noexcept
+	: previous(active_context)
+{
+	active_context = &active;
+}
+
+virtual_clock::context::scope::~scope()
+{
+	active_context = previous;
+}
 
 virtual_clock::system::time_point virtual_clock::system::now() noexcept
 {
-	return current_time.load();
+	return context::current().system_time.load();
 }
 
 std::time_t virtual_clock::system::to_time_t(const time_point& t)
@@ -43,22 +62,24 @@ virtual_clock::system::time_point virtual_clock::system::from_time_t(std::time_t
 
 void virtual_clock::system::advance(duration d) noexcept
 {
+	auto& current_time = context::current().system_time;
 	const auto tmp = current_time.load();
 	current_time.store(tmp + d);
 }
 
 void virtual_clock::system::set_time(time_point r) noexcept
 {
-	current_time.store(r);
+	context::current().system_time.store(r);
 }
 
 virtual_clock::steady::time_point virtual_clock::steady::now() noexcept
 {
-	return current_time.load();
+	return context::current().steady_time.load();
 }
 
 void virtual_clock::steady::advance(duration d) noexcept
 {
+	auto& current_time = context::current().steady_time;
 	const auto tmp = current_time.load();
 	current_time.store(tmp + d);
 }
@@ -36,6 +36,11 @@ struct wall_clock
  * The virtual clock is independent of the system real time clock.
  * It is used to determine timings in simulations and replays of logged data.
  * The clock itself is controlled by the scheduler of the application.
+ *
+ * The time is kept in a context. Every thread reads and advances the time of the context
+ * active in it, see context::scope. Without an active context, threads share a
+ * process wide default context. Thus several simulations can run in one process,
+ * each with its own time.
  */
 struct virtual_clock
 {
@@ -79,8 +84,6 @@ struct virtual_clock
 
 		static void advance(duration d) noexcept;
 		static void set_time(time_point r) noexcept;
-
-		static std::atomic<time_point> current_time;
 	};
 
 	/**
@@ -109,14 +112,55 @@ struct virtual_clock
 		friend class master_clock;
 
 		static void advance(duration d) noexcept;
+	};
+
+	/**
+	 * \brief the current time of a single simulation.
+	 *
+	 * The static clocks system and steady access the context, which is active
+	 * in the calling thread. Contexts are usually owned by the scheduler,
+	 * which activates them in all threads it runs tasks in.
+	 */
+	class context
+	{
+	public:
+		context() = default;
+		context(const context&) = delete;
+		context& operator=(const context&) = delete;
+
+		/// context used by all threads without an active context
+		static context& process_default() noexcept;
+		/// context active in the calling thread
+		static context& current() noexcept;
 
-		static std::atomic<time_point> current_time;
+		/**
+		 * \brief activates a context in the calling thread for its lifetime.
+		 * Scopes can be nested, the previous context is active again after destruction.
+		 */
+		class scope
+		{
+		public:
+			explicit scope(context& active) noexcept;
+			~scope();
+			scope(const scope&) = delete;
+			scope& operator=(const scope&) = delete;
+		private:
+			context* previous;
+		};
+
+	private:
+		friend system;
+		friend steady;
+
+		std::atomic<system::time_point> system_time{system::time_point{duration::zero()}};
+		std::atomic<steady::time_point> steady_time{steady::time_point{duration::zero()}};
 	};
 };
 
 /**
  * \brief controls the time of the two virtual clocks.
  *
+ * Changes the time of the context active in the calling thread.
  * \tparam period_t the period of a single tick. Is the smallest duration possible.
  */
 template<class period_t>
@@ -142,6 +186,16 @@ public:
 				std::chrono::duration_cast<virtual_clock::system::duration>
 				(duration(1)));
 	}
+	/**
+	 * \brief advances clock by the duration d
+	 *
+	 * Used if the length of a tick is only known at runtime.
+	 */
+	static void advance(virtual_clock::duration d) noexcept
+	{
+		steady_clock.advance(d);
+		system_clock.advance(d);
+	}
 	static void set_time(virtual_clock::system::time_point r) noexcept
 	{
 		system_clock.set_time(r);
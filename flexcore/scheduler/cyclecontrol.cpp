@@ -1,6 +1,7 @@
 #include "scheduler/cyclecontrol.hpp"
 
 #include <algorithm>
+#include <map>
 #include <stdexcept>
 
 namespace fc
@@ -8,32 +9,116 @@ namespace fc
 namespace thread
 {
 
-using clock = master_clock<std::centi>;
+using clock = master_clock<virtual_clock::period>;
 constexpr wall_clock::steady::duration cycle_control::min_tick_length;
 constexpr virtual_clock::steady::duration cycle_control::fast_tick;
 constexpr virtual_clock::steady::duration cycle_control::medium_tick;
 constexpr virtual_clock::steady::duration cycle_control::slow_tick;
+constexpr wall_clock::steady::duration periodic_task::unknown_cost;
+
+periodic_task periodic_task::fuse(std::vector<periodic_task>&& tasks)
+{
+	assert(!tasks.empty());
+	std::vector<std::function<void(void)>> jobs;
+	auto total_cost = wall_clock::steady::duration::zero();
+	bool cost_known = true;
+	for (auto& task : tasks)
+	{
+		const auto task_cost = task.cost();
+		cost_known = cost_known && task_cost != unknown_cost;
+		if (cost_known)
+			total_cost += task_cost;
+		jobs.push_back(std::move(task.work));
+	}
+
+	periodic_task fused{[jobs = std::move(jobs)]
+	{
+		for (const auto& job : jobs)
+			job();
+	}};
+	fused.group = tasks.front().group;
+	for (auto& task : tasks)
+	{
+		assert(task.done());
+		assert(task.group == fused.group);
+		fused.regions.insert(fused.regions.end(), task.regions.begin(), task.regions.end());
+	}
+	// keep the measured cost, so the fused task can be fused further after a restart.
+	if (cost_known)
+	{
+		fused.total_work_time = total_cost;
+		fused.nr_of_runs = 1;
+	}
+	return fused;
+}
+
+wall_clock::steady::duration periodic_task::cost() const
+{
+	const auto none = wall_clock::steady::duration::zero();
+	const bool all_declared = !regions.empty() && std::all_of(regions.begin(), regions.end(),
+			[none](const auto& region) { return region->declared_cost() > none; });
+	if (all_declared)
+	{
+		auto declared = none;
+		for (const auto& region : regions)
+			declared += region->declared_cost();
+		return declared;
+	}
+	if (nr_of_runs == 0)
+		return unknown_cost;
+	return total_work_time / nr_of_runs;
+}
+
+std::string periodic_task::name() const
+{
+	if (!label.empty() || regions.empty())
+		return label;
+	std::string joined = regions.front()->get_id().key;
+	for (auto region = regions.begin() + 1; region != regions.end(); ++region)
+		joined += "+" + (*region)->get_id().key;
+	return joined;
+}
+
+task_statistics periodic_task::statistics() const
+{
+	task_statistics stats;
+	stats.name = name();
+	stats.execution_time = timing->execution_time.snapshot();
+	stats.start_delay = timing->start_delay.snapshot();
+	stats.slack = timing->slack.snapshot();
+	stats.deadline_misses = timing->deadline_misses.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void periodic_task::reset_statistics()
+{
+	timing->execution_time.reset();
+	timing->start_delay.reset();
+	timing->slack.reset();
+	timing->deadline_misses.store(0, std::memory_order_relaxed);
+}
 
 cycle_control::cycle_control(std::unique_ptr<scheduler> scheduler,
-		 const std::shared_ptr<main_loop>& loop)
+		 const std::shared_ptr<main_loop>& loop,
+		 virtual_clock::steady::duration base_tick)
 	: cycle_control(std::move(scheduler), [this](auto& task)
 			{
 				return this->store_exception(task);
 			},
-			loop
+			loop,
+			base_tick
 	)
 {
 }
 
 void cycle_control::start()
 {
-	assert(!running);
-	keep_working.store(true);
-	running = true;
+	prepare_run();
 	//set the start time of the cycle to now.
 	// give the main thread some actual work to do (execute infinite main loop)
 	main_loop_thread = std::thread{
 		[&, this](){
+			virtual_clock::context::scope in_context{*time};
 			main_loop_->arm();
 			while(keep_working.load())
 				main_loop_->loop_body([this](){ work(); });
@@ -41,95 +126,253 @@ void cycle_control::start()
 	};
 }
 
+void cycle_control::run_until(const std::function<bool(void)>& done)
+{
+	prepare_run();
+	{
+		virtual_clock::context::scope in_context{*time};
+		while (keep_working.load() && !done())
+		{
+			work();
+			wait_for_current_tasks();
+			triggered_pending.wait_until(wall_clock::steady::now()
+					+ std::chrono::duration_cast<wall_clock::steady::duration>(slow_tick));
+		}
+	}
+	stop();
+}
+
+void cycle_control::prepare_run()
+{
+	assert(!running);
+	fuse_tasks();
+	organize_waves();
+	start_dedicated_workers();
+	set_lane_executors(true);
+	keep_working.store(true);
+	running = true;
+	accept_triggers.store(true);
+	// data which arrived while stopped is processed now.
+	for (auto& triggered : triggered_tasks)
+	{
+		triggered.scheduled.store(false);
+		triggered.deferred.store(false);
+		if (triggered.requested.load())
+			try_dispatch(triggered);
+	}
+}
+
 void cycle_control::stop()
 {
-	keep_working.store(false);
+	request_stop();
 	if (main_loop_thread.joinable())
 		main_loop_thread.join();
 	// wait for scheduled tasks to finish
-	auto wait_or_throw = [this](auto& task_vector)
-	{
-		for (auto& t : task_vector.tasks)
-			if (!t.wait_until_done(slow_tick))
-				timeout_callback(t);
-	};
-	wait_or_throw(tasks_fast);
-	wait_or_throw(tasks_medium);
-	wait_or_throw(tasks_slow);
+	for (auto& group : task_groups)
+		wait_for_group(group, std::max(group.tick, slow_tick));
+	// runs of triggered tasks can trigger further runs, until triggers are no longer accepted.
+	accept_triggers.store(false);
+	triggered_pending.wait_until(wall_clock::steady::now()
+			+ std::chrono::duration_cast<wall_clock::steady::duration>(slow_tick));
+	for (auto& group : task_groups)
+		for (auto& task : group.tasks)
+			task.dedicated = nullptr;
+	dedicated_workers.clear();
+	set_lane_executors(false);
 	running = false;
 	//check post condition
 	assert(!keep_working.load());
 	assert(!running);
 }
 
-bool cycle_control::store_exception(periodic_task&)
+bool cycle_control::store_exception(periodic_task& task)
 {
-	const auto ep = std::make_exception_ptr(out_of_time_exception());
-	std::lock_guard<std::mutex> lock(task_exception_mutex);
-	task_exceptions.push_back(ep);
+	const auto name = task.name();
+	const auto ep = name.empty()
+			? std::make_exception_ptr(out_of_time_exception())
+			: std::make_exception_ptr(out_of_time_exception(name));
+	{
+		std::lock_guard<std::mutex> lock(task_exception_mutex);
+		task_exceptions.push_back(ep);
+	}
+	task_exception_signal.notify_all();
 	return false;
 }
 
+void cycle_control::request_stop()
+{
+	keep_working.store(false);
+	// the lock orders the store before a waiter checking its condition
+	{
+		std::lock_guard<std::mutex> lock(task_exception_mutex);
+	}
+	task_exception_signal.notify_all();
+}
+
+bool cycle_control::wait_for_exception_until(wall_clock::steady::time_point deadline)
+{
+	std::unique_lock<std::mutex> lock(task_exception_mutex);
+	task_exception_signal.wait_until(lock, deadline, [this]
+	{
+		return !task_exceptions.empty() || !keep_working.load();
+	});
+	return keep_working.load();
+}
+
+void cycle_control::sync_group_wheel()
+{
+	const auto now = virtual_clock::steady::now().time_since_epoch();
+	const auto tick = static_cast<detail::timing_wheel::tick_t>(now / base_tick_);
+	// the virtual clock is shared with other instances, which might have moved it.
+	if (group_wheel.current() != tick)
+		group_wheel.reset(tick);
+}
+
+void cycle_control::sort_by_tick(std::vector<size_t>& groups) const
+{
+	std::sort(begin(groups), end(groups), [this](size_t a, size_t b)
+	{
+		return task_groups[a].tick < task_groups[b].tick;
+	});
+}
+
 void cycle_control::work()
 {
-	auto now = virtual_clock::steady::now().time_since_epoch();
-	auto run_if_due = [this, now](auto& task_vector)
+	virtual_clock::context::scope in_context{*time};
+	sync_group_wheel();
+	group_wheel.advance(current_groups);
+	sort_by_tick(current_groups);
+	clock::advance(base_tick_);
+	dispatch_deferred_triggers();
+	const bool shedding = overloaded();
+	cycle_late = false;
+	for (const size_t group : current_groups)
 	{
-		if (now % task_vector.tick == virtual_clock::duration::zero())
-			if (!run_periodic_tasks(task_vector))
-				return false;
-		return true;
-	};
-	clock::advance();
-	if (!run_if_due(tasks_fast)) return;
-	if (!run_if_due(tasks_medium)) return;
-	if (!run_if_due(tasks_slow)) return;
+		auto& tasks = task_groups[group];
+		if (shedding && overrun->shed(tasks.tick, fastest_tick))
+		{
+			overruns.shed_groups.fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+		const bool keep_going = run_periodic_tasks(tasks);
+		// buffers between regions of different tick rates are switched by both regions,
+		// thus the switch phases of the groups must not overlap.
+		run_switch_phase();
+		if (!keep_going)
+			break;
+	}
+	post_dedicated(dedicated_batch);
+	// hand the work of all groups to the scheduler at once
+	dispatched_runs.fetch_add(batch.size(), std::memory_order_relaxed);
+	scheduler_->add_tasks(batch);
+	// cheap tasks are executed here, while the workers already execute the expensive ones.
+	for (periodic_task& task : inline_batch)
+		task();
+	inline_runs.fetch_add(inline_batch.size(), std::memory_order_relaxed);
+	inline_batch.clear();
+}
+
+void cycle_control::skip_idle_ticks()
+{
+	virtual_clock::context::scope in_context{*time};
+	sync_group_wheel();
+	const auto current = group_wheel.current();
+	const auto next = group_wheel.next_due();
+	if (group_wheel.empty() || next <= current)
+		return;
+	clock::advance(base_tick_ * static_cast<virtual_clock::duration::rep>(next - current));
+	group_wheel.skip_to(next);
 }
 
 void cycle_control::wait_for_current_tasks()
 {
-	auto now = virtual_clock::steady::now().time_since_epoch();
-	auto wait_for_tasks = [this, now](auto& task_vector)
+	virtual_clock::context::scope in_context{*time};
+	sync_group_wheel();
+	group_wheel.due_at_current(current_groups);
+	sort_by_tick(current_groups);
+	// wait for slow tasks first, as they take longest.
+	for (auto group = current_groups.rbegin(); group != current_groups.rend(); ++group)
 	{
-		if (now % task_vector.tick == virtual_clock::duration::zero())
+		if (!wait_for_group(task_groups[*group], task_groups[*group].tick))
 		{
-			for (auto& task : task_vector.tasks)
-				if (!task.wait_until_done(task_vector.tick))
-				{
-					if (!timeout_callback(task))
-					{
-						keep_working.store(false);
-						return false;
-					}
-				}
+			request_stop();
+			return;
 		}
+	}
+}
+
+bool cycle_control::overloaded() const
+{
+	return cycle_late || std::any_of(begin(current_groups), end(current_groups),
+			[this](size_t group) { return task_groups[group].pending->count() != 0; });
+}
+
+late_cycle_action cycle_control::handle_late_cycle(uint64_t missed_ticks)
+{
+	const auto action = overrun->late_cycle(missed_ticks);
+	overruns.late_cycles.fetch_add(1, std::memory_order_relaxed);
+	cycle_late = true;
+	switch (action)
+	{
+	case late_cycle_action::catch_up:
+		overruns.caught_up_cycles.fetch_add(1, std::memory_order_relaxed);
+		break;
+	case late_cycle_action::skip:
+	{
+		// the groups due in the missed ticks are left out, as the wheel follows the clock.
+		virtual_clock::context::scope in_context{*time};
+		clock::advance(base_tick_ * static_cast<virtual_clock::duration::rep>(missed_ticks));
+		overruns.skipped_ticks.fetch_add(missed_ticks, std::memory_order_relaxed);
+		break;
+	}
+	case late_cycle_action::stretch:
+		overruns.stretched_cycles.fetch_add(1, std::memory_order_relaxed);
+		break;
+	}
+	return action;
+}
+
+bool cycle_control::wait_for_group(tick_task_pair& group,
+		virtual_clock::steady::duration timeout)
+{
+	if (group.pending->wait_until(group.dispatch_time + timeout))
 		return true;
-	};
-	if (!wait_for_tasks(tasks_slow)) return;
-	if (!wait_for_tasks(tasks_medium)) return;
-	if (!wait_for_tasks(tasks_fast)) return;
+	for (auto& task : group.tasks)
+		if (!task.done() && !timeout_callback(task))
+			return false;
+	return true;
 }
 
 cycle_control::~cycle_control()
 {
 	stop();
+	for (auto& triggered : triggered_tasks)
+		triggered.task.regions.front()->on_data_arrived = nullptr;
 	assert(!running);
 }
 
 bool cycle_control::run_periodic_tasks(tick_task_pair& tasks)
 {
+	if (!tasks.waves.empty())
+		return run_in_waves(tasks);
+
 	assert(tasks.done_tasks.empty());
+	// if nothing of this group is pending, all tasks are done and don't need to be checked.
+	const bool all_done = tasks.pending->count() == 0;
 	for (auto& task : tasks.tasks)
 	{
-		if (!task.done())
+		if (!all_done && !task.done())
 		{
 			if (!timeout_callback(task))
 			{
-				keep_working.store(false);
+				request_stop();
 				return false;
 			}
 			if (!task.done())
+			{
+				overruns.skipped_tasks.fetch_add(1, std::memory_order_relaxed);
 				continue;
+			}
 		}
 		tasks.done_tasks.emplace_back(task);
 	}
@@ -139,30 +382,547 @@ bool cycle_control::run_periodic_tasks(tick_task_pair& tasks)
 		periodic_task& task = task_ref.get();
 		assert(task.done());
 		task.set_work_to_do(true);
-		task.send_switch_tick();
+		switch_buffers(task);
 	}
+	tasks.dispatch_time = wall_clock::steady::now();
+	// tasks need to be done before the next cycle of their group starts.
+	scheduling_hints hints;
+	hints.deadline = tasks.dispatch_time
+			+ std::chrono::duration_cast<wall_clock::steady::duration>(tasks.tick);
+	detail::countdown_latch& pending = *tasks.pending;
+	virtual_clock::context& context = *time;
+	int32_t dispatched = 0;
 	for (auto& task_ref : tasks.done_tasks)
 	{
 		periodic_task& task = task_ref.get();
-		scheduler_->add_task([&task] { task(); });
+		task.release_time = tasks.dispatch_time;
+		task.deadline = hints.deadline;
+		if (execute_inline(task))
+		{
+			inline_batch.push_back(task);
+			continue;
+		}
+		++dispatched;
+		hints.worker_group = task.worker_group();
+		auto job = [&task, &pending, &context]
+		{
+			virtual_clock::context::scope in_context{context};
+			task();
+			pending.count_down();
+		};
+		if (task.dedicated)
+			dedicated_batch.emplace_back(task.dedicated, std::move(job));
+		else
+			batch.push_back(scheduled_task{std::move(job), hints});
 	}
+	pending.add(dispatched);
 	tasks.done_tasks.clear();
 	return true;
 }
 
+bool cycle_control::run_in_waves(tick_task_pair& tasks)
+{
+	if (tasks.pending->count() != 0)
+	{
+		for (auto& task : tasks.tasks)
+		{
+			if (!task.done() && !timeout_callback(task))
+			{
+				request_stop();
+				return false;
+			}
+		}
+		if (tasks.pending->count() != 0)
+		{
+			overruns.skipped_tasks.fetch_add(tasks.tasks.size(), std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	for (auto& task : tasks.tasks)
+	{
+		assert(task.done());
+		task.set_work_to_do(true);
+		switch_buffers(task);
+	}
+	tasks.pending->add(static_cast<int32_t>(tasks.tasks.size()));
+	tasks.dispatch_time = wall_clock::steady::now();
+	tasks.wave_remaining->store(static_cast<int32_t>(tasks.waves.front().size()));
+	append_wave(tasks, 0, batch, dedicated_batch, tasks.dispatch_time);
+	return true;
+}
+
+void cycle_control::append_wave(tick_task_pair& group, size_t wave,
+		std::vector<scheduled_task>& out, std::vector<dedicated_job>& dedicated_out,
+		wall_clock::steady::time_point release)
+{
+	scheduling_hints hints;
+	hints.deadline = group.dispatch_time
+			+ std::chrono::duration_cast<wall_clock::steady::duration>(group.tick);
+	for (periodic_task& task : group.waves[wave])
+	{
+		task.release_time = release;
+		task.deadline = hints.deadline;
+		hints.worker_group = task.worker_group();
+		auto job = [this, &group, &task, wave]
+		{
+			virtual_clock::context::scope in_context{*time};
+			task();
+			// the next wave is counted in pending already,
+			// so the group can't appear done before it has run.
+			if (group.wave_remaining->fetch_sub(1, std::memory_order_acq_rel) == 1)
+				start_wave(group, wave + 1);
+			group.pending->count_down();
+		};
+		if (task.dedicated)
+			dedicated_out.emplace_back(task.dedicated, std::move(job));
+		else
+			out.push_back(scheduled_task{std::move(job), hints});
+	}
+}
+
+void cycle_control::start_wave(tick_task_pair& group, size_t wave)
+{
+	if (wave == group.waves.size())
+		return;
+	group.wave_remaining->store(static_cast<int32_t>(group.waves[wave].size()),
+			std::memory_order_release);
+	// every wave has its own batch, as a blocking scheduler starts the next wave
+	// while it still iterates over the current one.
+	auto& wave_batch = group.wave_batches[wave];
+	std::vector<dedicated_job> dedicated_jobs;
+	append_wave(group, wave, wave_batch, dedicated_jobs, wall_clock::steady::now());
+	post_dedicated(dedicated_jobs);
+	dispatched_runs.fetch_add(wave_batch.size(), std::memory_order_relaxed);
+	scheduler_->add_tasks(wave_batch);
+}
+
+void cycle_control::organize_waves()
+{
+	for (auto& group : task_groups)
+	{
+		std::map<size_t, std::vector<std::reference_wrapper<periodic_task>>> by_wave;
+		for (auto& task : group.tasks)
+			by_wave[task.wave()].emplace_back(task);
+
+		group.waves.clear();
+		group.wave_batches.clear();
+		if (by_wave.size() < 2)
+			continue;
+		for (auto& wave : by_wave)
+			group.waves.push_back(std::move(wave.second));
+		group.wave_batches.resize(group.waves.size());
+	}
+}
+
+void cycle_control::fuse_tasks()
+{
+	if (fusion_budget <= wall_clock::steady::duration::zero())
+		return;
+
+	for (auto& group : task_groups)
+	{
+		// only regions which run in the same wave on the same workers are fused.
+		std::map<std::pair<size_t, int>, std::vector<size_t>> candidates;
+		for (size_t i = 0; i != group.tasks.size(); ++i)
+		{
+			const auto& task = group.tasks[i];
+			if (task.nr_of_regions() != 0 && !task.wants_dedicated_thread()
+					&& task.cost() < fusion_budget)
+				candidates[std::make_pair(task.wave(), task.worker_group())].push_back(i);
+		}
+
+		// first fit decreasing, every bin becomes one task.
+		std::vector<std::vector<size_t>> bins;
+		std::vector<wall_clock::steady::duration> bin_costs;
+		for (auto& candidate : candidates)
+		{
+			auto& indices = candidate.second;
+			std::sort(indices.begin(), indices.end(), [&group](size_t a, size_t b)
+			{
+				return group.tasks[a].cost() > group.tasks[b].cost();
+			});
+			const size_t first_bin = bins.size();
+			for (const size_t i : indices)
+			{
+				const auto task_cost = group.tasks[i].cost();
+				size_t bin = first_bin;
+				while (bin != bins.size() && bin_costs[bin] + task_cost > fusion_budget)
+					++bin;
+				if (bin == bins.size())
+				{
+					bins.emplace_back();
+					bin_costs.push_back(wall_clock::steady::duration::zero());
+				}
+				bins[bin].push_back(i);
+				bin_costs[bin] += task_cost;
+			}
+		}
+
+		const bool fuses_any = std::any_of(bins.begin(), bins.end(),
+				[](const auto& bin) { return bin.size() > 1; });
+		if (!fuses_any)
+			continue;
+
+		std::vector<periodic_task> tasks;
+		std::vector<bool> fused(group.tasks.size(), false);
+		for (const auto& bin : bins)
+		{
+			if (bin.size() < 2)
+				continue;
+			std::vector<periodic_task> members;
+			for (const size_t i : bin)
+			{
+				members.emplace_back(std::move(group.tasks[i]));
+				fused[i] = true;
+			}
+			tasks.emplace_back(periodic_task::fuse(std::move(members)));
+		}
+		for (size_t i = 0; i != group.tasks.size(); ++i)
+			if (!fused[i])
+				tasks.emplace_back(std::move(group.tasks[i]));
+		group.tasks.swap(tasks);
+	}
+}
+
+void cycle_control::switch_buffers(periodic_task& task)
+{
+	if (switch_helpers == 0)
+		task.send_switch_tick();
+	else
+		due_switches.emplace_back(task);
+}
+
+void cycle_control::switch_phase::help()
+{
+	for (size_t i = next.fetch_add(1); i < tasks.size(); i = next.fetch_add(1))
+	{
+		tasks[i].get().send_switch_tick();
+		remaining.count_down();
+	}
+}
+
+void cycle_control::run_switch_phase()
+{
+	if (due_switches.size() < 2)
+	{
+		for (periodic_task& task : due_switches)
+			task.send_switch_tick();
+		due_switches.clear();
+		return;
+	}
+
+	// helpers of earlier cycles, which have not run yet, still hold the previous phase.
+	if (!current_switch || current_switch.use_count() != 1)
+		current_switch = std::make_shared<switch_phase>();
+	auto& phase = *current_switch;
+	phase.tasks.swap(due_switches);
+	due_switches.clear();
+	phase.next.store(0);
+	phase.remaining.add(static_cast<int32_t>(phase.tasks.size()));
+
+	scheduling_hints hints;
+	hints.deadline = wall_clock::steady::now();
+	const size_t helpers = std::min(switch_helpers, phase.tasks.size() - 1);
+	virtual_clock::context& context = *time;
+	for (size_t i = 0; i != helpers; ++i)
+	{
+		switch_batch.push_back(scheduled_task{[shared = current_switch, &context]
+		{
+			virtual_clock::context::scope in_context{context};
+			shared->help();
+		}, hints});
+	}
+	scheduler_->add_tasks(switch_batch);
+	phase.help();
+	// barrier between switch and work phase
+	phase.remaining.wait_until(wall_clock::steady::time_point::max());
+}
+
+void cycle_control::post_dedicated(std::vector<dedicated_job>& jobs)
+{
+	for (auto& job : jobs)
+		job.first->post(std::move(job.second));
+	dispatched_runs.fetch_add(jobs.size(), std::memory_order_relaxed);
+	jobs.clear();
+}
+
+void cycle_control::start_dedicated_workers()
+{
+	for (auto& group : task_groups)
+	{
+		for (auto& task : group.tasks)
+		{
+			if (!task.wants_dedicated_thread())
+				continue;
+			dedicated_workers.push_back(std::make_unique<detail::dedicated_worker>(
+					task.regions.front()->dedicated_thread()));
+			task.dedicated = dedicated_workers.back().get();
+		}
+	}
+}
+
+void cycle_control::set_lane_executors(bool enable)
+{
+	const auto connect = [this, enable](periodic_task& task)
+	{
+		for (const auto& region : task.regions)
+		{
+			if (!enable)
+				region->ticks.lane_executor = nullptr;
+			else if (region->ticks.nr_of_lanes() > 1)
+				region->ticks.lane_executor = [this, &task](size_t count,
+						const std::function<void(size_t)>& body)
+				{
+					run_lanes(task, count, body);
+				};
+		}
+	};
+	for (auto& group : task_groups)
+		for (auto& task : group.tasks)
+			connect(task);
+	for (auto& triggered : triggered_tasks)
+		connect(triggered.task);
+}
+
+void cycle_control::lane_phase::help()
+{
+	for (size_t lane = next.fetch_add(1); lane < count; lane = next.fetch_add(1))
+	{
+		(*body)(lane);
+		remaining.count_down();
+	}
+}
+
+void cycle_control::run_lanes(const periodic_task& task, size_t count,
+		const std::function<void(size_t)>& body)
+{
+	auto phase = std::make_shared<lane_phase>();
+	phase->body = &body;
+	phase->count = count;
+	phase->remaining.add(static_cast<int32_t>(count));
+
+	scheduling_hints hints;
+	hints.deadline = task.deadline;
+	hints.worker_group = task.worker_group();
+	virtual_clock::context& context = *time;
+	for (size_t i = 1; i < count; ++i)
+	{
+		scheduler_->add_task([phase, &context]
+		{
+			virtual_clock::context::scope in_context{context};
+			phase->help();
+		}, hints);
+	}
+	phase->help();
+	// join, the region is only done once all of its lanes are.
+	phase->remaining.wait_until(wall_clock::steady::time_point::max());
+}
+
+bool cycle_control::execute_inline(periodic_task& task)
+{
+	if (inline_threshold <= wall_clock::steady::duration::zero()
+			|| task.worker_group() != any_worker_group || task.dedicated)
+		return false;
+
+	const auto cost = task.recent_cost();
+	const bool was_inline = task.inline_execution;
+	const bool is_inline = cost != periodic_task::unknown_cost
+			&& (was_inline ? cost <= 2 * inline_threshold : cost < inline_threshold);
+	if (is_inline != was_inline)
+	{
+		task.inline_execution = is_inline;
+		if (is_inline)
+			nr_of_inline_tasks.fetch_add(1, std::memory_order_relaxed);
+		else
+			nr_of_inline_tasks.fetch_sub(1, std::memory_order_relaxed);
+	}
+	return is_inline;
+}
+
+void cycle_control::set_inline_threshold(wall_clock::steady::duration threshold)
+{
+	assert(!running);
+	inline_threshold = threshold;
+}
+
+execution_statistics cycle_control::execution_stats() const
+{
+	execution_statistics stats;
+	stats.inline_runs = inline_runs.load(std::memory_order_relaxed);
+	stats.dispatched_runs = dispatched_runs.load(std::memory_order_relaxed);
+	stats.inline_tasks = nr_of_inline_tasks.load(std::memory_order_relaxed);
+	stats.triggered_runs = triggered_runs.load(std::memory_order_relaxed);
+	return stats;
+}
+
+std::vector<task_statistics> cycle_control::task_stats() const
+{
+	std::vector<size_t> groups(task_groups.size());
+	for (size_t i = 0; i != groups.size(); ++i)
+		groups[i] = i;
+	sort_by_tick(groups);
+
+	std::vector<task_statistics> stats;
+	for (const size_t group : groups)
+	{
+		for (const auto& task : task_groups[group].tasks)
+		{
+			stats.push_back(task.statistics());
+			stats.back().tick = task_groups[group].tick;
+		}
+	}
+	for (const auto& triggered : triggered_tasks)
+	{
+		stats.push_back(triggered.task.statistics());
+		stats.back().tick = std::chrono::duration_cast<virtual_clock::steady::duration>(
+				triggered.min_interval);
+	}
+	return stats;
+}
+
+void cycle_control::reset_task_stats()
+{
+	for (auto& group : task_groups)
+		for (auto& task : group.tasks)
+			task.reset_statistics();
+	for (auto& triggered : triggered_tasks)
+		triggered.task.reset_statistics();
+}
+
+void cycle_control::set_overrun_policy(std::unique_ptr<overrun_policy> policy)
+{
+	assert(!running);
+	assert(policy);
+	overrun = std::move(policy);
+}
+
+overrun_statistics cycle_control::overrun_stats() const
+{
+	overrun_statistics stats;
+	stats.late_cycles = overruns.late_cycles.load(std::memory_order_relaxed);
+	stats.caught_up_cycles = overruns.caught_up_cycles.load(std::memory_order_relaxed);
+	stats.skipped_ticks = overruns.skipped_ticks.load(std::memory_order_relaxed);
+	stats.stretched_cycles = overruns.stretched_cycles.load(std::memory_order_relaxed);
+	stats.shed_groups = overruns.shed_groups.load(std::memory_order_relaxed);
+	stats.skipped_tasks = overruns.skipped_tasks.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void cycle_control::set_parallel_switch(size_t helpers)
+{
+	assert(!running);
+	switch_helpers = helpers;
+}
+
+void cycle_control::set_fusion_budget(wall_clock::steady::duration budget)
+{
+	assert(!running);
+	fusion_budget = budget;
+}
+
 void cycle_control::add_task(periodic_task task, virtual_clock::duration tick_rate)
 {
 	if (running)
 		throw std::runtime_error{"Worker threads are already running"};
 
-	if (tick_rate == slow_tick)
-		tasks_slow.tasks.emplace_back(std::move(task));
-	else if (tick_rate == medium_tick)
-		tasks_medium.tasks.emplace_back(std::move(task));
-	else if (tick_rate == fast_tick)
-		tasks_fast.tasks.emplace_back(std::move(task));
-	else
+	if (tick_rate <= virtual_clock::duration::zero()
+			|| tick_rate % base_tick_ != virtual_clock::duration::zero())
 		throw std::invalid_argument{"Unsupported tick_rate"};
+
+	auto group = std::find_if(begin(task_groups), end(task_groups),
+			[tick_rate](const tick_task_pair& g) { return g.tick == tick_rate; });
+	if (group == end(task_groups))
+	{
+		task_groups.push_back(tick_task_pair{tick_rate});
+		group_wheel.add(task_groups.size() - 1,
+				static_cast<detail::timing_wheel::tick_t>(tick_rate / base_tick_));
+		group = end(task_groups) - 1;
+		if (fastest_tick == virtual_clock::duration::zero() || tick_rate < fastest_tick)
+			fastest_tick = tick_rate;
+	}
+	group->tasks.emplace_back(std::move(task));
+}
+
+void cycle_control::add_triggered_task(periodic_task task)
+{
+	if (running)
+		throw std::runtime_error{"Worker threads are already running"};
+	if (task.regions.size() != 1 || !task.regions.front()->is_event_triggered())
+		throw std::invalid_argument{"triggered tasks need a single event triggered region"};
+
+	const auto min_interval = task.regions.front()->min_trigger_interval();
+	triggered_tasks.emplace_back(std::move(task), min_interval);
+	triggered_task& triggered = triggered_tasks.back();
+	triggered.task.regions.front()->on_data_arrived = [this, &triggered]
+	{
+		trigger(triggered);
+	};
+}
+
+void cycle_control::trigger(triggered_task& task)
+{
+	task.requested.store(true);
+	try_dispatch(task);
+}
+
+void cycle_control::try_dispatch(triggered_task& task)
+{
+	if (!accept_triggers.load())
+		return;
+	// a scheduled run picks up the data, or dispatches again once it is done.
+	if (task.scheduled.exchange(true))
+		return;
+	const auto now = wall_clock::steady::now().time_since_epoch().count();
+	if (now < task.next_start.load(std::memory_order_relaxed))
+	{
+		task.deferred.store(true);
+		return;
+	}
+	dispatch_triggered(task);
+}
+
+void cycle_control::dispatch_triggered(triggered_task& task)
+{
+	assert(task.task.done());
+	task.task.set_work_to_do(true);
+	task.task.release_time = wall_clock::steady::now();
+	task.task.deadline = task.task.release_time + task.min_interval;
+	scheduling_hints hints;
+	hints.deadline = task.task.deadline;
+	hints.worker_group = task.task.worker_group();
+	triggered_pending.add(1);
+	dispatched_runs.fetch_add(1, std::memory_order_relaxed);
+	scheduler_->add_task([this, &task] { run_triggered(task); }, hints);
+}
+
+void cycle_control::run_triggered(triggered_task& task)
+{
+	virtual_clock::context::scope in_context{*time};
+	// data arriving from now on is either collected by this run or triggers the next.
+	task.requested.store(false);
+	task.next_start.store((wall_clock::steady::now() + task.min_interval).time_since_epoch().count(),
+			std::memory_order_relaxed);
+	task.task.send_switch_tick();
+	task.task();
+	triggered_runs.fetch_add(1, std::memory_order_relaxed);
+	task.scheduled.store(false);
+	if (task.requested.load())
+		try_dispatch(task);
+	triggered_pending.count_down();
+}
+
+void cycle_control::dispatch_deferred_triggers()
+{
+	if (triggered_tasks.empty())
+		return;
+	const auto now = wall_clock::steady::now().time_since_epoch().count();
+	for (auto& task : triggered_tasks)
+	{
+		if (task.deferred.load() && now >= task.next_start.load(std::memory_order_relaxed)
+				&& task.deferred.exchange(false))
+			dispatch_triggered(task);
+	}
 }
 
 std::exception_ptr cycle_control::last_exception()
@@ -182,11 +942,39 @@ void cycle_control::set_main_loop(const std::shared_ptr<main_loop>& loop)
 	assert(loop);
 	main_loop_ = loop;
 	main_loop_->wait_for_current_tasks = [this](){ wait_for_current_tasks(); };
+	main_loop_->skip_idle_ticks = [this](){ skip_idle_ticks(); };
+	main_loop_->late_cycle = [this](uint64_t missed){ return handle_late_cycle(missed); };
+	main_loop_->tick_length = std::chrono::duration_cast<wall_clock::steady::duration>(base_tick_);
+}
+
+void cycle_control::set_clock_context(virtual_clock::context& context)
+{
+	assert(!running);
+	time = &context;
+}
+
+wall_clock::steady::time_point main_loop::handle_late_start(wall_clock::steady::time_point start)
+{
+	const auto now = wall_clock::steady::now();
+	if (!late_cycle || now - start < tick_length)
+		return start;
+	const auto missed = static_cast<uint64_t>((now - start) / tick_length);
+	switch (late_cycle(missed))
+	{
+	case late_cycle_action::skip:
+		return start + tick_length * static_cast<wall_clock::steady::duration::rep>(missed);
+	case late_cycle_action::stretch:
+		return now;
+	case late_cycle_action::catch_up:
+		break;
+	}
+	return start;
 }
 
 void realtime_main_loop::loop_body(const std::function<void(void)>& work)
 {
-	epoch += cycle_control::min_tick_length;
+	epoch = handle_late_start(epoch);
+	epoch += tick_length;
 	work();
 	std::this_thread::sleep_until(epoch);
 }
@@ -199,12 +987,12 @@ void timewarp_main_loop::loop_body(const std::function<void(void)>& work)
 	std::unique_lock<std::mutex> lock(warp_mutex);
 	assert(warp_factor >= 0.0);
 	warp_signal.wait_until(lock,
-			epoch + cycle_control::min_tick_length * warp_factor,
+			epoch + tick_length * warp_factor,
 			[this]()
 			{
-				return wall_clock::steady::now() >= epoch + cycle_control::min_tick_length * warp_factor;
+				return wall_clock::steady::now() >= epoch + tick_length * warp_factor;
 			});
-	epoch += std::chrono::duration_cast<decltype(epoch)::duration>(cycle_control::min_tick_length * warp_factor);
+	epoch += std::chrono::duration_cast<decltype(epoch)::duration>(tick_length * warp_factor);
 }
 
 void timewarp_main_loop::set_warp_factor(double factor)
@@ -221,5 +1009,12 @@ void afap_main_loop::loop_body(const std::function<void(void)>& work)
 	work();
 }
 
+void discrete_event_main_loop::loop_body(const std::function<void(void)>& work)
+{
+	skip_idle_ticks();
+	wait_for_current_tasks();
+	work();
+}
+
 } /* namespace thread */
 } /* namespace fc */
@@ -4,14 +4,24 @@
 #include "scheduler/clock.hpp"
 #include "scheduler/scheduler.hpp"
 #include "scheduler/parallelregion.hpp"
+#include "scheduler/detail/dedicated_worker.hpp"
+#include "scheduler/detail/futex.hpp"
+#include "scheduler/detail/timing_wheel.hpp"
+#include "scheduler/latency_histogram.hpp"
+#include "scheduler/overrunpolicy.hpp"
 #include "pure/event_sources.hpp"
 
+#include <atomic>
 #include <cassert>
 #include <condition_variable>
+#include <cstdint>
 #include <deque>
 #include <mutex>
 #include <memory>
+#include <stdexcept>
+#include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 namespace fc
@@ -20,64 +30,194 @@ namespace fc
 /// Classes and Functions related to the multithreading model of flexcore.
 namespace thread
 {
-namespace detail
+/// timing of the runs of a periodic_task, see periodic_task::statistics
+struct task_statistics
 {
-struct condition_pair
-{
-	std::mutex mtx;
-	std::condition_variable cv;
+	/// name of the task, see periodic_task::name
+	std::string name;
+	/// tick rate of the task, zero if the task is not part of a cycle_control
+	virtual_clock::steady::duration tick = virtual_clock::steady::duration::zero();
+	/// time from the start of the work to its end
+	latency_statistics execution_time;
+	/// time from the handover of the task to the scheduler to the start of its work
+	latency_statistics start_delay;
+	/// time from the end of the work to its deadline, zero for runs which missed it
+	latency_statistics slack;
+	/// number of runs which ended after their deadline
+	uint64_t deadline_misses = 0;
 };
-}
 
 /**
  * \brief class representing a task
  * which is executed with a fixed rate by the scheduler.
+ *
+ * The state of the task is kept in a single atomic word,
+ * thus checking and changing it does not need any locks.
+ * A task is idle until it is scheduled by cycle_control,
+ * running while its work executes and idle again afterwards.
+ *
+ * A task either executes a plain job or the work ticks of one or more parallel regions.
+ *
+ * Every run is recorded in histograms of its execution time, its start delay
+ * and its slack against the deadline set by cycle_control.
+ * Recording is lock-free and only costs a few relaxed atomic increments per run.
  */
 struct periodic_task final
 {
+	/// states of a periodic_task
+	enum class state : int32_t
+	{
+		idle = 0,
+		scheduled = 1,
+		running = 2
+	};
+
+	/// cost of tasks which neither declared their cost nor have run yet
+	static constexpr wall_clock::steady::duration unknown_cost =
+			wall_clock::steady::duration::max();
+
 	/**
 	 * \brief Constructor taking a job
 	 * \param job task which is to be executed every cycle
 	 * \pre job must not be empty
 	 */
 	explicit periodic_task(std::function<void(void)> job)
-		: work_to_do(false)
-		, sync(std::make_unique<detail::condition_pair>())
-		, work(std::move(job))
+		: work(std::move(job))
 		, work_start(wall_clock::steady::now())
-		, region(nullptr)
+		, regions()
+		, timing(std::make_unique<histograms>())
 	{
 		assert(work);
 	}
-	/// Construct a periodic task executes work within a region
-	explicit periodic_task(const std::shared_ptr<parallel_region>& r) :
-				work_to_do(false),
-				sync(std::make_unique<detail::condition_pair>()),
+	/**
+	 * \brief Construct a periodic task executes work within a region
+	 * \param group_ worker group which executes the work, see scheduler_config.
+	 */
+	explicit periodic_task(const std::shared_ptr<parallel_region>& r,
+			int group_ = any_worker_group) :
 				work(r->ticks.in_work()),
 				work_start(wall_clock::steady::now()),
-				region(r)
+				regions{r},
+				group(group_),
+				timing(std::make_unique<histograms>())
 	{
 		assert(r != nullptr);
 		assert(work);
 	}
 
+	/// \pre other is idle
+	periodic_task(periodic_task&& other) noexcept
+		: work(std::move(other.work))
+		, work_start(other.work_start)
+		, release_time(other.release_time)
+		, deadline(other.deadline)
+		, regions(std::move(other.regions))
+		, group(other.group)
+		, label(std::move(other.label))
+		, timing(std::move(other.timing))
+		, total_work_time(other.total_work_time)
+		, recent_work_time(other.recent_work_time)
+		, nr_of_runs(other.nr_of_runs)
+		, inline_execution(other.inline_execution)
+		, dedicated(other.dedicated)
+	{
+		assert(other.done());
+	}
+
+	/**
+	 * \brief combines tasks into a single task, which executes their work one after another.
+	 *
+	 * The switch ticks of all regions are sent together, so buffers between the regions
+	 * keep switching at the start of each cycle.
+	 * \pre tasks is not empty, all tasks are idle and belong to the same worker group.
+	 */
+	static periodic_task fuse(std::vector<periodic_task>&& tasks);
+
+	/// worker group which executes this task
+	int worker_group() const { return group; }
+
+	/// wave of the regions of this task, 0 if the task is not ordered, see parallel_region::wave
+	size_t wave() const
+	{
+		return !regions.empty() && regions.front()->wave != parallel_region::unordered
+				? regions.front()->wave : 0;
+	}
+
+	/// number of parallel regions executed by this task
+	size_t nr_of_regions() const { return regions.size(); }
+
+	/**
+	 * \brief expected execution time of a single cycle.
+	 *
+	 * The sum of the costs declared by the regions if all of them declared one,
+	 * otherwise the mean of the measured execution times, or unknown_cost if the task never ran.
+	 * \pre task is idle
+	 */
+	wall_clock::steady::duration cost() const;
+
+	/**
+	 * \brief execution time of the recent cycles, weighted towards the most recent ones.
+	 * unknown_cost if the task never ran.
+	 * \pre task is idle
+	 */
+	wall_clock::steady::duration recent_cost() const
+	{
+		return nr_of_runs == 0 ? unknown_cost : recent_work_time;
+	}
+
+	/**
+	 * \brief name of the task used in statistics.
+	 * The name set with set_name, otherwise the keys of the regions separated by '+',
+	 * or an empty string for plain jobs.
+	 */
+	std::string name() const;
+	/// sets a name for the task, which replaces the names of its regions.
+	void set_name(std::string name) { label = std::move(name); }
+
+	/**
+	 * \brief timing of all runs since construction or the last reset_statistics.
+	 * May be called while the task runs, the histograms are then slightly inconsistent.
+	 */
+	task_statistics statistics() const;
+	/// clears the recorded timing, not atomic with respect to a running task.
+	void reset_statistics();
+
+	/// true if the task executes a single region, which asks for a thread of its own.
+	bool wants_dedicated_thread() const
+	{
+		return regions.size() == 1 && regions.front()->has_dedicated_thread();
+	}
+
+	/// true if cycle_control executes this task on the main loop thread.
+	bool runs_inline() const { return inline_execution; }
+
 	///returns true if all work in task is complete
-	bool done()
+	bool done() const
+	{
+		return current_state() == state::idle;
+	}
+
+	state current_state() const
 	{
-		std::lock_guard<std::mutex> lock(sync->mtx);
-		return !work_to_do;
+		return static_cast<state>(state_word.load(std::memory_order_acquire) & ~waiting_flag);
 	}
 
 	///notify task if more work is to be done
 	void set_work_to_do(bool todo)
 	{
+		if (todo)
+		{
+			assert(done());
+			state_word.store(static_cast<int32_t>(state::scheduled), std::memory_order_release);
+		}
+		else
 		{
-			std::lock_guard<std::mutex> lock(sync->mtx);
-			work_to_do = todo;
+			// if we're done then notify all waiters
+			const int32_t previous = state_word.exchange(
+					static_cast<int32_t>(state::idle), std::memory_order_seq_cst);
+			if (previous & waiting_flag)
+				detail::futex_wake_all(state_word);
 		}
-		// if we're done then notify all waiters
-		if (todo == false)
-			sync->cv.notify_all();
 	}
 
 	/** \brief waits for this task to be done, but only until the provided timeout.
@@ -85,37 +225,89 @@ struct periodic_task final
 	 */
 	bool wait_until_done(virtual_clock::steady::duration timeout)
 	{
-		std::unique_lock<std::mutex> lock(sync->mtx);
-		return sync->cv.wait_until(
-				lock,
-				work_start + timeout,
-				[this](){ return !this->work_to_do; }
-		);
+		const auto deadline = work_start + timeout;
+		while (true)
+		{
+			int32_t current = state_word.load(std::memory_order_acquire);
+			if ((current & ~waiting_flag) == static_cast<int32_t>(state::idle))
+				return true;
+			if (wall_clock::steady::now() >= deadline)
+				return false;
+			if (!(current & waiting_flag) && !state_word.compare_exchange_strong(
+					current, current | waiting_flag, std::memory_order_seq_cst))
+				continue;
+			detail::futex_wait_until(state_word, current | waiting_flag, deadline);
+		}
 	}
 
-	///trigger switch tick of associated parallel_region if it is registered.
+	///trigger switch ticks of associated parallel_regions.
 	void send_switch_tick()
 	{
-		if (region)
+		for (const auto& region : regions)
 			region->ticks.switch_buffers();
 	}
 
 	void operator()()
 	{
 		work_start = wall_clock::steady::now();
+		state_word.fetch_add(static_cast<int32_t>(state::running)
+				- static_cast<int32_t>(state::scheduled), std::memory_order_relaxed);
 		work();
+		for (const auto& region : regions)
+			region->ticks.finish_work();
+		const auto work_end = wall_clock::steady::now();
+		const auto work_time = work_end - work_start;
+		timing->execution_time.record(work_time);
+		timing->start_delay.record(work_start - release_time);
+		if (work_end <= deadline)
+			timing->slack.record(deadline - work_end);
+		else
+			timing->deadline_misses.fetch_add(1, std::memory_order_relaxed);
+		total_work_time += work_time;
+		recent_work_time = nr_of_runs == 0
+				? work_time : recent_work_time + (work_time - recent_work_time) / 8;
+		++nr_of_runs;
 		set_work_to_do(false);
 	}
 private:
-	/// flag to check if work has already been executed this cycle.
-	bool work_to_do;
-	std::unique_ptr<detail::condition_pair> sync;
+	/// set in state_word if a thread waits for the task to be done.
+	static constexpr int32_t waiting_flag = 0x100;
+	/// current state and waiting_flag
+	std::atomic<int32_t> state_word{static_cast<int32_t>(state::idle)};
 	/// work to be done every cycle
 	std::function<void(void)> work;
 	/// start time of most recent work cycle
 	wall_clock::steady::time_point work_start;
+	/// time at which the task was most recently handed over for execution
+	wall_clock::steady::time_point release_time{};
+	/// time by which the current run should be finished
+	wall_clock::steady::time_point deadline = wall_clock::steady::time_point::max();
+
+	std::vector<std::shared_ptr<parallel_region>> regions;
+	int group = any_worker_group;
+	/// name set with set_name
+	std::string label{};
 
-	std::shared_ptr<parallel_region> region;
+	struct histograms
+	{
+		latency_histogram execution_time;
+		latency_histogram start_delay;
+		latency_histogram slack;
+		std::atomic<uint64_t> deadline_misses{0};
+	};
+	/// kept separately, so moving a task does not copy its histograms
+	std::unique_ptr<histograms> timing;
+	/// sum of the execution times of all runs, only accessed by the thread running the task.
+	wall_clock::steady::duration total_work_time = wall_clock::steady::duration::zero();
+	/// moving average of the execution times
+	wall_clock::steady::duration recent_work_time = wall_clock::steady::duration::zero();
+	uint64_t nr_of_runs = 0;
+	/// only accessed by the thread running cycle_control::work
+	bool inline_execution = false;
+	/// thread executing this task while cycle_control runs, nullptr if the scheduler does.
+	detail::dedicated_worker* dedicated = nullptr;
+
+	friend class cycle_control;
 };
 
 ///Abstract Base class for all main lopp classes.
@@ -128,6 +320,20 @@ public:
 	virtual void arm() = 0;
 
 	std::function<void(void)> wait_for_current_tasks{};
+	/// advances the virtual clock to the next tick at which any task is due, set by cycle_control
+	std::function<void(void)> skip_idle_ticks{};
+	/// decides how to continue after cycles have been missed, set by cycle_control
+	std::function<late_cycle_action(uint64_t)> late_cycle{};
+	/// duration of a single cycle, set by cycle_control
+	wall_clock::steady::duration tick_length{parallel_region::min_tick_length};
+
+protected:
+	/**
+	 * \brief checks if the cycle scheduled at start is late by at least a tick
+	 * and applies the decision of late_cycle.
+	 * \return start time of the cycle, later than start if cycles are skipped or stretched.
+	 */
+	wall_clock::steady::time_point handle_late_start(wall_clock::steady::time_point start);
 };
 
 /**
@@ -141,6 +347,22 @@ public:
 	void arm() override {};
 };
 
+/**
+ * \brief Main Loop which runs as fast as possible and skips cycles in which no task is due.
+ *
+ * Instead of advancing the virtual clock tick by tick, the clock jumps straight
+ * to the next tick at which any task is due. The tasks run at the same virtual times
+ * as with afap_main_loop, but idle ticks cost nothing,
+ * which speeds up simulations dominated by slow regions.
+ */
+class discrete_event_main_loop final : public main_loop
+{
+public:
+	void loop_body(const std::function<void(void)>& work) override;
+
+	void arm() override {};
+};
+
 /**
  * \brief Main Loop which runs in realtime.
  */
@@ -174,15 +396,38 @@ private:
 	wall_clock::steady::time_point epoch{wall_clock::steady::now()};
 };
 
+/// how cycle_control executed its tasks, see cycle_control::set_inline_threshold
+struct execution_statistics
+{
+	/// number of task executions on the main loop thread
+	uint64_t inline_runs = 0;
+	/// number of task executions handed to the scheduler
+	uint64_t dispatched_runs = 0;
+	/// number of tasks, which are currently executed on the main loop thread
+	size_t inline_tasks = 0;
+	/// number of runs of event triggered tasks, see cycle_control::add_triggered_task
+	uint64_t triggered_runs = 0;
+};
+
 /**
  * \brief Controls timing and the execution of cyclic tasks in the scheduler.
+ *
+ * The duration of a single cycle (base_tick) is set at construction and defaults to
+ * min_tick_length. Tasks are grouped by their tick rate,
+ * tick rates can be any multiple of the base tick.
+ * The groups are kept in a timing wheel, so the cost of a tick only depends
+ * on the number of groups which are actually due and not on the number of different rates.
+ *
+ * If the regions of a group are ordered by their dependencies (see parallel_region::wave),
+ * the tasks of a group are run in waves. The tasks of a wave are handed to the scheduler
+ * once the last task of the previous wave is done.
  * Todo: allow to set virtual clock as control clock for replay as template parameter
- * todo: allow to set min_tick_length
  */
 class cycle_control
 {
 public:
 	//forward definitions of tick rates for use in scheduler
+	/// default duration of a single cycle
 	static constexpr auto min_tick_length = parallel_region::min_tick_length;
 	static constexpr auto fast_tick =  parallel_region::fast_tick;
 	static constexpr auto medium_tick =  parallel_region::medium_tick;
@@ -192,13 +437,16 @@ public:
 	 * \brief construct cycle_control with a scheduler and a main loop functor
 	 * \param scheduler scheduler for work ticks to be used.
 	 * \param loop functor which controls the main loop
+	 * \param base_tick duration of a single cycle.
 	 * \pre loop != nullptr
 	 * \pre scheduler != nullptr
+	 * \pre base_tick > 0, otherwise std::invalid_argument is thrown.
 	 *
 	 * \see parallel_scheduler for an example of a scheduler.
 	 */
 	explicit cycle_control(std::unique_ptr<scheduler> scheduler,
-			const std::shared_ptr<main_loop>& loop = std::make_shared<realtime_main_loop>());
+			const std::shared_ptr<main_loop>& loop = std::make_shared<realtime_main_loop>(),
+			virtual_clock::steady::duration base_tick = min_tick_length);
 
 	/**
 	 * \brief Construct cycle_control together with a user controled timeout handler
@@ -206,13 +454,16 @@ public:
 	 * \param loop functor which controls the main loop
 	 * \param err TimeOutHandler, is triggered when the scheduler notices
 	 * that a work tick takes to long.
+	 * \param base_tick duration of a single cycle.
 	 * \pre loop != nullptr
 	 * \pre scheduler != nullptr
+	 * \pre base_tick > 0, otherwise std::invalid_argument is thrown.
 	 */
 	template <class TimeOutFun>
 	cycle_control(std::unique_ptr<scheduler> scheduler,
 			TimeOutFun err,
-			const std::shared_ptr<main_loop>& loop);
+			const std::shared_ptr<main_loop>& loop,
+			virtual_clock::steady::duration base_tick = min_tick_length);
 
 	~cycle_control();
 
@@ -220,20 +471,68 @@ public:
 	void start();
 	/// halts the main loop without joining worker threads
 	void stop();
+	/**
+	 * \brief executes cycles on the calling thread, as fast as possible, until done returns true.
+	 *
+	 * Every cycle advances the virtual clock by a single tick and waits for all of its tasks,
+	 * then done is checked, thus the result only depends on the virtual time
+	 * and not on the main loop or the wall clock.
+	 * Returns early if a task does not finish in time and the timeout callback requests to stop.
+	 * The cycle_control is stopped afterwards.
+	 * \pre cycle_control is not running
+	 */
+	void run_until(const std::function<bool(void)>& done);
+
+	/**
+	 * \brief blocks until a task exception is available, the cycle_control stops or deadline passes.
+	 *
+	 * Wakes immediately on exceptions and stop requests, use last_exception to get the exception.
+	 * \return false if the cycle_control is stopped or stopping.
+	 */
+	bool wait_for_exception_until(wall_clock::steady::time_point deadline);
 
 	/// advances the clock by a single tick and executes all tasks for the cycle.
 	void work();
 
+	/**
+	 * \brief advances the clock to the next tick at which any task is due.
+	 * Does nothing if tasks are due at the current tick or if there are no tasks.
+	 * \post the next call to work executes at least one group of tasks, if there are any.
+	 */
+	void skip_idle_ticks();
+
+	/// duration of a single cycle, all tick rates are multiples of it.
+	virtual_clock::steady::duration base_tick() const { return base_tick_; }
+
 	/**
 	 * \brief adds a new cyclic task with the given tick_rate.
 	 * Tasks can only be added as long as the cycle_control has not been started. A
 	 * std::runtime_error exception will be thrown if an attempt is made to add a task to a running
 	 * cycle_control.
+	 * A std::invalid_argument exception is thrown if tick_rate is not a positive multiple
+	 * of base_tick().
 	 *
 	 * \pre cycle_control is not running
+	 * \pre tick_rate is a positive multiple of base_tick()
 	 * \post list of tasks for given tick_rate is not empty
 	 */
 	void add_task(periodic_task task, virtual_clock::duration tick_rate);
+	/**
+	 * \brief adds a task, which runs whenever events arrive for its region.
+	 *
+	 * The region of the task is triggered by its buffers (see parallel_region::trigger_on_events).
+	 * Arrivals while the task is scheduled or running are coalesced into a single further run.
+	 * Runs start at least parallel_region::min_trigger_interval apart, triggers arriving
+	 * earlier are deferred and dispatched by the main loop, thus with the resolution
+	 * of base_tick(). The task is handed to the same scheduler as periodic tasks.
+	 * Triggers are only accepted while the cycle_control runs, triggers which arrive
+	 * while it is stopped are dispatched on start.
+	 * A std::runtime_error exception is thrown if the cycle_control is running.
+	 * A std::invalid_argument exception is thrown if the task does not execute
+	 * exactly one event triggered region.
+	 * \pre cycle_control is not running
+	 */
+	void add_triggered_task(periodic_task task);
 	/// returns the number of currently scheduled tasks
 	size_t nr_of_tasks() const { return scheduler_->nr_of_waiting_tasks(); }
 
@@ -248,21 +547,276 @@ public:
 	 */
 	void set_main_loop(const std::shared_ptr<main_loop>& loop);
 
+	/// context of the virtual clock advanced by this cycle_control
+	virtual_clock::context& clock_context() const { return *time; }
+	/**
+	 * \brief sets the context of the virtual clock to advance.
+	 *
+	 * The context is active in the main loop and in all tasks run by this cycle_control.
+	 * Defaults to the process wide context, cycle_controls with different contexts
+	 * advance their time independently of each other.
+	 * \pre scheduler is not running
+	 * \pre context outlives the cycle_control
+	 */
+	void set_clock_context(virtual_clock::context& context);
+
+	/**
+	 * \brief enables fusion of cheap regions into combined tasks.
+	 *
+	 * When started, regions with the same tick rate, wave and worker group,
+	 * whose cost (see periodic_task::cost) is known and below budget, are packed into
+	 * combined tasks, each with a total cost of at most budget.
+	 * This saves the overhead of scheduling many tiny tasks.
+	 * Fusion is permanent, a zero budget, the default, disables further fusion.
+	 * \pre scheduler is not running
+	 */
+	void set_fusion_budget(wall_clock::steady::duration budget);
+
+	/**
+	 * \brief enables execution of cheap tasks directly on the main loop thread.
+	 *
+	 * Handing a task to the scheduler and back costs more than the work of very cheap tasks.
+	 * Tasks whose recent execution time (see periodic_task::recent_cost) is below threshold
+	 * are executed by the main loop thread, after the expensive tasks have been dispatched.
+	 * A task only returns to the scheduler once its recent execution time exceeds
+	 * twice the threshold, so tasks close to the threshold don't switch back and forth.
+	 * Tasks bound to a worker group and tasks of regions ordered in waves always
+	 * go to the scheduler. A zero threshold, the default, disables inline execution.
+	 * \pre scheduler is not running
+	 */
+	void set_inline_threshold(wall_clock::steady::duration threshold);
+
+	/// counts of inline and dispatched task executions since start.
+	execution_statistics execution_stats() const;
+
+	/**
+	 * \brief switches the buffers of the due regions in parallel.
+	 *
+	 * By default the main loop thread sends the switch ticks of all due tasks one after another.
+	 * With helpers > 0, up to helpers tasks are handed to the scheduler, which send the
+	 * switch ticks together with the main loop thread. The groups of different tick rates
+	 * are switched one after another, since buffers between them are switched by both sides.
+	 * The work of the cycle is only dispatched once all buffers are switched,
+	 * so regions never see half switched inputs.
+	 * Worthwhile if switching copies large states. Zero, the default, switches serially.
+	 * \pre scheduler is not running
+	 */
+	void set_parallel_switch(size_t helpers);
+
+	/**
+	 * \brief sets how overload is handled, see overrun_policy.
+	 * Defaults to catch_up_policy without limit.
+	 * \pre policy != nullptr
+	 * \pre scheduler is not running
+	 */
+	void set_overrun_policy(std::unique_ptr<overrun_policy> policy);
+	/// counts of the decisions of the overrun policy since construction.
+	overrun_statistics overrun_stats() const;
+
+	/**
+	 * \brief timing of every task, see periodic_task::statistics.
+	 *
+	 * Can be called while the scheduler is running, to find the tasks responsible
+	 * for tail latencies and overruns. Tasks are listed by tick rate,
+	 * after start the combined tasks of fused regions replace the single regions.
+	 */
+	std::vector<task_statistics> task_stats() const;
+	/// clears the timing of all tasks
+	void reset_task_stats();
+
 private:
 	struct tick_task_pair
 	{
 		virtual_clock::steady::duration tick;
 		std::vector<periodic_task> tasks{};
 		std::vector<std::reference_wrapper<periodic_task>> done_tasks{};
+		/// number of tasks of this group which have been scheduled but are not done yet.
+		std::unique_ptr<detail::countdown_latch> pending =
+				std::make_unique<detail::countdown_latch>();
+		/// time at which tasks of this group have been scheduled most recently
+		wall_clock::steady::time_point dispatch_time{wall_clock::steady::now()};
+		/// tasks ordered by the wave of their region, empty if the group has a single wave.
+		std::vector<std::vector<std::reference_wrapper<periodic_task>>> waves{};
+		/// work of every wave, reused in every cycle
+		std::vector<std::vector<scheduled_task>> wave_batches{};
+		/// number of tasks of the current wave, which are not done yet.
+		std::unique_ptr<std::atomic<int32_t>> wave_remaining =
+				std::make_unique<std::atomic<int32_t>>(0);
 	};
 
-	/// runs the tasks in this vector; returns false if any task is not done, true otherwise
+	/**
+	 * \brief prepares the tasks of the group and adds them to batch.
+	 * \return false if a task was not done and the timeout_callback requested to stop.
+	 */
 	bool run_periodic_tasks(tick_task_pair& tasks);
+	/// sends the switch tick of task now or collects it for the parallel switch phase
+	void switch_buffers(periodic_task& task);
+	/// sends all collected switch ticks and returns once all of them are done.
+	void run_switch_phase();
+	/// decides if task is executed inline, see set_inline_threshold
+	bool execute_inline(periodic_task& task);
+	/// asks the overrun policy and applies its decision to the virtual clock.
+	late_cycle_action handle_late_cycle(uint64_t missed_ticks);
+	/// true if the current cycle started late or tasks of a due group are still running.
+	bool overloaded() const;
+	/**
+	 * \brief prepares all tasks of a group with several waves and adds the first wave to batch.
+	 *
+	 * Since later waves are started by the tasks themselves,
+	 * the group is skipped as a whole, if any of its tasks is not done.
+	 * \return false if a task was not done and the timeout_callback requested to stop.
+	 */
+	bool run_in_waves(tick_task_pair& tasks);
+	/// work of a task for its dedicated thread
+	using dedicated_job = std::pair<detail::dedicated_worker*, std::function<void(void)>>;
+	/**
+	 * \brief adds the tasks of wave to out, or to dedicated_out if they have a dedicated thread.
+	 * The last of them to finish starts the next wave.
+	 */
+	void append_wave(tick_task_pair& group, size_t wave, std::vector<scheduled_task>& out,
+			std::vector<dedicated_job>& dedicated_out, wall_clock::steady::time_point release);
+	/// hands jobs to their dedicated threads \pre the jobs are counted in pending of their group
+	void post_dedicated(std::vector<dedicated_job>& jobs);
+	/// hands the tasks of wave to the scheduler, called once the previous wave is done.
+	void start_wave(tick_task_pair& group, size_t wave);
+	/// sorts the tasks of every group into waves by the order of their regions.
+	void organize_waves();
+	/// combines cheap region tasks of every group within fusion_budget.
+	void fuse_tasks();
+	/// starts a dedicated_worker for every task, which wants a thread of its own.
+	void start_dedicated_workers();
+	/// lets regions with independent work ticks fan them out to the scheduler, or stops it.
+	void set_lane_executors(bool enable);
+	/**
+	 * \brief calls body for every lane of a region of task and joins them.
+	 * Up to count - 1 helpers are handed to the scheduler, the calling thread helps as well.
+	 */
+	void run_lanes(const periodic_task& task, size_t count,
+			const std::function<void(size_t)>& body);
 	void wait_for_current_tasks();
+	/**
+	 * \brief waits until all tasks of group are done, but not beyond dispatch time + timeout.
+	 * calls timeout_callback for every task which is not done in time.
+	 * \return false if the timeout_callback requested to stop.
+	 */
+	bool wait_for_group(tick_task_pair& group, virtual_clock::steady::duration timeout);
+	/// moves group_wheel to the current tick of the virtual clock
+	void sync_group_wheel();
+	/// sorts indices of task_groups from fastest to slowest tick rate
+	void sort_by_tick(std::vector<size_t>& groups) const;
+	/// prepares the tasks for execution, shared by start and run_until.
+	void prepare_run();
+	/// lets the main loop end and wakes threads waiting in wait_for_exception_until.
+	void request_stop();
+
+	/// task of an event triggered region, see add_triggered_task
+	struct triggered_task
+	{
+		triggered_task(periodic_task task, wall_clock::steady::duration min_interval)
+			: task(std::move(task)), min_interval(min_interval)
+		{
+		}
 
-	tick_task_pair tasks_slow{slow_tick};
-	tick_task_pair tasks_medium{medium_tick};
-	tick_task_pair tasks_fast{fast_tick};
+		periodic_task task;
+		wall_clock::steady::duration min_interval;
+		/// set when data arrives, cleared when a run starts
+		std::atomic<bool> requested{false};
+		/// set while the task is deferred, handed to the scheduler or running
+		std::atomic<bool> scheduled{false};
+		/// set while the task waits for next_start
+		std::atomic<bool> deferred{false};
+		/// earliest start of the next run, as time since epoch of wall_clock::steady
+		std::atomic<wall_clock::steady::duration::rep> next_start{0};
+	};
+	/// called by the region of task whenever data arrives for it.
+	void trigger(triggered_task& task);
+	/// hands task to the scheduler unless it is scheduled already or needs to be deferred.
+	void try_dispatch(triggered_task& task);
+	/// \pre task.scheduled is owned by the caller
+	void dispatch_triggered(triggered_task& task);
+	/// executes a single run of task, on a thread of the scheduler.
+	void run_triggered(triggered_task& task);
+	/// dispatches deferred triggered tasks whose next_start has passed, called every cycle.
+	void dispatch_deferred_triggers();
+
+	/// duration of a single cycle
+	virtual_clock::steady::duration base_tick_;
+	/// context of the virtual clock, which is advanced by this cycle_control
+	virtual_clock::context* time = &virtual_clock::context::process_default();
+	/// maximum cost of fused tasks, zero if fusion is disabled
+	wall_clock::steady::duration fusion_budget = wall_clock::steady::duration::zero();
+	/// maximum recent cost of tasks executed inline, zero if inline execution is disabled
+	wall_clock::steady::duration inline_threshold = wall_clock::steady::duration::zero();
+	/// switch ticks of a cycle, shared with the tasks which help sending them
+	struct switch_phase
+	{
+		std::vector<std::reference_wrapper<periodic_task>> tasks{};
+		/// index of the next task to switch
+		std::atomic<size_t> next{0};
+		/// number of tasks, which are not switched yet
+		detail::countdown_latch remaining{};
+		/// switches tasks until all of them have been taken.
+		void help();
+	};
+	/// independent work ticks of a region run, shared with the tasks which help running them
+	struct lane_phase
+	{
+		/// \pre only called for lanes below count, while the caller of run_lanes waits.
+		const std::function<void(size_t)>* body = nullptr;
+		size_t count = 0;
+		/// index of the next lane to run
+		std::atomic<size_t> next{0};
+		/// number of lanes, which are not done yet
+		detail::countdown_latch remaining{};
+		/// runs lanes until all of them have been taken.
+		void help();
+	};
+	/// maximum number of tasks helping with the switch phase, zero switches serially.
+	size_t switch_helpers = 0;
+	/// tasks whose switch ticks are sent in the switch phase of the current cycle
+	std::vector<std::reference_wrapper<periodic_task>> due_switches{};
+	/// kept alive by helpers, which start late, reused if no helper holds it anymore
+	std::shared_ptr<switch_phase> current_switch{};
+	std::vector<scheduled_task> switch_batch{};
+	/// tasks of the current cycle to be executed on the main loop thread
+	std::vector<std::reference_wrapper<periodic_task>> inline_batch{};
+	/// threads of regions with a dedicated thread, exist while the cycle_control runs
+	std::vector<std::unique_ptr<detail::dedicated_worker>> dedicated_workers{};
+	/// work of the current cycle for dedicated threads, posted after the switch phase
+	std::vector<dedicated_job> dedicated_batch{};
+	std::atomic<uint64_t> inline_runs{0};
+	std::atomic<uint64_t> dispatched_runs{0};
+	std::atomic<size_t> nr_of_inline_tasks{0};
+	/// tasks of event triggered regions, in a deque, as they are referenced by their regions
+	std::deque<triggered_task> triggered_tasks{};
+	/// number of runs of triggered tasks, which have been dispatched but are not done yet.
+	detail::countdown_latch triggered_pending{};
+	/// false while the cycle_control is stopped, triggers are only recorded then.
+	std::atomic<bool> accept_triggers{false};
+	std::atomic<uint64_t> triggered_runs{0};
+	std::unique_ptr<overrun_policy> overrun = std::make_unique<catch_up_policy>();
+	/// decisions of the overrun policy, see overrun_statistics
+	struct overrun_counters
+	{
+		std::atomic<uint64_t> late_cycles{0};
+		std::atomic<uint64_t> caught_up_cycles{0};
+		std::atomic<uint64_t> skipped_ticks{0};
+		std::atomic<uint64_t> stretched_cycles{0};
+		std::atomic<uint64_t> shed_groups{0};
+		std::atomic<uint64_t> skipped_tasks{0};
+	} overruns{};
+	/// set by the main loop if the current cycle started late
+	bool cycle_late = false;
+	/// tick rate of the fastest group, zero if there are no tasks
+	virtual_clock::steady::duration fastest_tick = virtual_clock::steady::duration::zero();
+	/// one group of tasks for every tick rate in use
+	std::vector<tick_task_pair> task_groups{};
+	/// schedules task_groups, ids in the wheel are indices into task_groups
+	detail::timing_wheel group_wheel{};
+	/// indices of the groups due in the current cycle, ordered from fastest to slowest
+	std::vector<size_t> current_groups{};
+	/// work of the current cycle, handed to the scheduler at once
+	std::vector<scheduled_task> batch{};
 	std::unique_ptr<scheduler> scheduler_;
 	std::atomic<bool> keep_working{false};
 	bool running = false;
@@ -272,6 +826,8 @@ private:
 
 	//Thread exception handling
 	std::mutex task_exception_mutex;
+	/// signaled when an exception is stored or the cycle_control stops
+	std::condition_variable task_exception_signal;
 	std::deque<std::exception_ptr> task_exceptions;
 	/** Callback that is called when a task takes too long.
 	 * Expected to return true if the scheduler is to continue and false if
@@ -283,15 +839,19 @@ private:
 
 template <class TimeOutFun>
 inline cycle_control::cycle_control(std::unique_ptr<scheduler> scheduler,
-		TimeOutFun callback, const std::shared_ptr<main_loop>& loop)
-	: scheduler_(std::move(scheduler))
+		TimeOutFun callback, const std::shared_ptr<main_loop>& loop,
+		virtual_clock::steady::duration base_tick)
+	: base_tick_(base_tick)
+	, scheduler_(std::move(scheduler))
 	, main_loop_(loop)
 	, timeout_callback(std::move(callback))
 {
 	assert(scheduler_);
 	assert(main_loop_);
 	assert(timeout_callback);
-	main_loop_->wait_for_current_tasks = [this](){ wait_for_current_tasks(); };
+	if (base_tick_ <= virtual_clock::steady::duration::zero())
+		throw std::invalid_argument{"base tick needs to be positive"};
+	set_main_loop(loop);
 }
 
 } /* namespace thread */
@@ -302,6 +862,11 @@ struct out_of_time_exception: std::runtime_error
 			std::runtime_error("cyclic task has not finished in time")
 	{
 	}
+	/// \param task name of the task, which has not finished in time
+	explicit out_of_time_exception(const std::string& task) :
+			std::runtime_error("cyclic task " + task + " has not finished in time")
+	{
+	}
 };
 
 } /* namespace fc */
@@ -0,0 +1,131 @@
+#ifndef SRC_SCHEDULER_DETAIL_DEDICATED_WORKER_HPP_
+#define SRC_SCHEDULER_DETAIL_DEDICATED_WORKER_HPP_
+
+#include "scheduler/detail/futex.hpp"
+#include "scheduler/parallelregion.hpp"
+#include "scheduler/schedulerconfig.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fc
+{
+namespace thread
+{
+namespace detail
+{
+
+/**
+ * \brief thread which executes the jobs posted to it and nothing else.
+ *
+ * Used by cycle_control for regions with a dedicated thread.
+ * Posting a job wakes the thread directly with a futex,
+ * or, if the thread spins, without any system call.
+ */
+class dedicated_worker
+{
+public:
+	/**
+	 * \throws std::invalid_argument if config.cpus contains an invalid cpu index.
+	 * \throws std::system_error if the thread cannot be pinned to config.cpus.
+	 * The thread is joined before the exception leaves the constructor.
+	 */
+	explicit dedicated_worker(const dedicated_thread_config& config)
+		: spin(config.spin)
+		, worker([this] { run(); })
+	{
+		try
+		{
+			if (!config.cpus.empty())
+				set_affinity(worker, config.cpus);
+		}
+		catch (...)
+		{
+			shut_down();
+			throw;
+		}
+	}
+
+	dedicated_worker(const dedicated_worker&) = delete;
+	dedicated_worker& operator=(const dedicated_worker&) = delete;
+
+	/// finishes the posted jobs and joins the thread.
+	~dedicated_worker() { shut_down(); }
+
+	/// hands job to the thread, jobs are executed in the order in which they are posted.
+	void post(std::function<void(void)> job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(jobs_mutex);
+			jobs.push_back(std::move(job));
+		}
+		notify();
+	}
+
+	/// id of the thread, which executes the jobs
+	std::thread::id id() const { return worker.get_id(); }
+
+private:
+	void shut_down()
+	{
+		keep_running.store(false);
+		notify();
+		worker.join();
+	}
+
+	void notify()
+	{
+		posted.fetch_add(1, std::memory_order_seq_cst);
+		if (!spin)
+			futex_wake_all(posted);
+	}
+
+	void run()
+	{
+		std::vector<std::function<void(void)>> current;
+		int32_t seen = 0;
+		while (true)
+		{
+			int32_t now_posted = posted.load(std::memory_order_acquire);
+			while (now_posted == seen)
+			{
+				if (spin)
+					cpu_relax();
+				else
+					futex_wait_until(posted, seen, wall_clock::steady::time_point::max());
+				now_posted = posted.load(std::memory_order_acquire);
+			}
+			seen = now_posted;
+			// jobs posted before the shutdown are taken by the swap below
+			const bool stopping = !keep_running.load();
+
+			{
+				std::lock_guard<std::mutex> lock(jobs_mutex);
+				current.swap(jobs);
+			}
+			for (const auto& job : current)
+				job();
+			current.clear();
+			if (stopping)
+				return;
+		}
+	}
+
+	const bool spin;
+	/// incremented for every posted job and on shutdown
+	std::atomic<int32_t> posted{0};
+	std::atomic<bool> keep_running{true};
+	std::mutex jobs_mutex;
+	std::vector<std::function<void(void)>> jobs;
+	std::thread worker;
+};
+
+} // namespace detail
+} // namespace thread
+} // namespace fc
+
+#endif /* SRC_SCHEDULER_DETAIL_DEDICATED_WORKER_HPP_ */
@@ -0,0 +1,130 @@
+#ifndef SRC_SCHEDULER_DETAIL_FUTEX_HPP_
+#define SRC_SCHEDULER_DETAIL_FUTEX_HPP_
+
+#include "scheduler/clock.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace fc
+{
+namespace thread
+{
+namespace detail
+{
+
+static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t),
+		"futex operations need a plain 32 bit word");
+
+/**
+ * \brief blocks while word contains expected, but not beyond deadline.
+ *
+ * May return spuriously, callers need to check their condition again.
+ * On linux this is a futex wait, other systems fall back to a short sleep.
+ */
+inline void futex_wait_until(std::atomic<int32_t>& word, int32_t expected,
+		wall_clock::steady::time_point deadline)
+{
+#ifdef __linux__
+	// FUTEX_WAIT_BITSET takes an absolute timeout on CLOCK_MONOTONIC,
+	// which std::chrono::steady_clock is based on.
+	const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			deadline.time_since_epoch()).count();
+	timespec timeout{};
+	timeout.tv_sec = static_cast<time_t>(ns / 1000000000);
+	timeout.tv_nsec = static_cast<long>(ns % 1000000000);
+	syscall(SYS_futex, reinterpret_cast<int32_t*>(&word),
+			FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG, expected, &timeout,
+			nullptr, FUTEX_BITSET_MATCH_ANY);
+#else
+	if (word.load() == expected)
+		std::this_thread::sleep_for(std::chrono::microseconds(50));
+	(void)deadline;
+#endif
+}
+
+/// tells the cpu that we are in a spin loop, which reduces power and frees resources for smt
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#endif
+}
+
+/// wakes all threads blocked in futex_wait_until on word
+inline void futex_wake_all(std::atomic<int32_t>& word)
+{
+#ifdef __linux__
+	syscall(SYS_futex, reinterpret_cast<int32_t*>(&word),
+			FUTEX_WAKE | FUTEX_PRIVATE_FLAG, INT_MAX, nullptr, nullptr, 0);
+#else
+	(void)word;
+#endif
+}
+
+/**
+ * \brief counter of outstanding work which threads can wait on until it reaches zero.
+ *
+ * Unlike a classic latch, the count can be raised again at any time with add,
+ * so a single instance can track work over many cycles.
+ * count_down only makes a system call if a thread is actually waiting.
+ */
+class countdown_latch
+{
+public:
+	countdown_latch() = default;
+	countdown_latch(const countdown_latch&) = delete;
+	countdown_latch& operator=(const countdown_latch&) = delete;
+
+	/// raises the count by n \pre n >= 0
+	void add(int32_t n) noexcept { remaining.fetch_add(n, std::memory_order_relaxed); }
+
+	/// lowers the count by one and wakes all waiters if it reaches zero.
+	void count_down() noexcept
+	{
+		if (remaining.fetch_sub(1, std::memory_order_seq_cst) == 1
+				&& waiters.load(std::memory_order_seq_cst) != 0)
+			futex_wake_all(remaining);
+	}
+
+	int32_t count() const noexcept { return remaining.load(std::memory_order_acquire); }
+
+	/**
+	 * \brief blocks until the count is zero, but not beyond deadline.
+	 * \return true if the count reached zero.
+	 */
+	bool wait_until(wall_clock::steady::time_point deadline)
+	{
+		while (true)
+		{
+			const int32_t current = remaining.load(std::memory_order_acquire);
+			if (current == 0)
+				return true;
+			if (wall_clock::steady::now() >= deadline)
+				return false;
+			waiters.fetch_add(1, std::memory_order_seq_cst);
+			futex_wait_until(remaining, current, deadline);
+			waiters.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+
+private:
+	std::atomic<int32_t> remaining{0};
+	std::atomic<int32_t> waiters{0};
+};
+
+} // namespace detail
+} // namespace thread
+} // namespace fc
+
+#endif /* SRC_SCHEDULER_DETAIL_FUTEX_HPP_ */
@@ -0,0 +1,123 @@
+#ifndef SRC_SCHEDULER_DETAIL_INJECTION_QUEUE_HPP_
+#define SRC_SCHEDULER_DETAIL_INJECTION_QUEUE_HPP_
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace fc
+{
+namespace thread
+{
+namespace detail
+{
+
+/**
+ * \brief bounded lock-free multi producer multi consumer queue.
+ *
+ * Used to inject tasks from threads outside of a thread pool into the pool.
+ * Every slot carries a sequence number which tells producers and consumers
+ * whether the slot is free or filled in the current round, see
+ * Dmitry Vyukov's bounded MPMC queue.
+ *
+ * \tparam T type of elements, needs to be trivially copyable. Usually a pointer.
+ */
+template<class T>
+class injection_queue
+{
+	static_assert(std::is_trivially_copyable<T>{},
+			"injection_queue can only store trivially copyable elements.");
+public:
+	/// \pre capacity is a power of two and larger than one
+	explicit injection_queue(size_t capacity = 4096)
+		: mask(capacity - 1)
+		, cells(std::make_unique<cell[]>(capacity))
+		, enqueue_pos(0)
+		, dequeue_pos(0)
+	{
+		assert(capacity > 1);
+		assert((capacity & (capacity - 1)) == 0);
+		for (size_t i = 0; i != capacity; ++i)
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	injection_queue(const injection_queue&) = delete;
+	injection_queue& operator=(const injection_queue&) = delete;
+
+	/// \return false if the queue is full, true if element was added.
+	bool try_push(T element)
+	{
+		size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+		cell* c = nullptr;
+		while (true)
+		{
+			c = &cells[pos & mask];
+			const size_t seq = c->sequence.load(std::memory_order_acquire);
+			const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+			if (diff == 0)
+			{
+				if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+				return false;
+			else
+				pos = enqueue_pos.load(std::memory_order_relaxed);
+		}
+		c->data = element;
+		c->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/// \return false if the queue is empty, true if an element was written to out.
+	bool try_pop(T& out)
+	{
+		size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+		cell* c = nullptr;
+		while (true)
+		{
+			c = &cells[pos & mask];
+			const size_t seq = c->sequence.load(std::memory_order_acquire);
+			const auto diff =
+					static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+			if (diff == 0)
+			{
+				if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+				return false;
+			else
+				pos = dequeue_pos.load(std::memory_order_relaxed);
+		}
+		out = c->data;
+		c->sequence.store(pos + mask + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	struct cell
+	{
+		std::atomic<size_t> sequence;
+		T data;
+	};
+
+	static constexpr size_t cache_line = 64;
+
+	const size_t mask;
+	std::unique_ptr<cell[]> cells;
+	// padding keeps producers and consumers from sharing a cache line
+	char pad_0[cache_line];
+	std::atomic<size_t> enqueue_pos;
+	char pad_1[cache_line];
+	std::atomic<size_t> dequeue_pos;
+	char pad_2[cache_line];
+};
+
+} // namespace detail
+} // namespace thread
+} // namespace fc
+
+#endif /* SRC_SCHEDULER_DETAIL_INJECTION_QUEUE_HPP_ */
@@ -0,0 +1,173 @@
+#ifndef SRC_SCHEDULER_DETAIL_TIMING_WHEEL_HPP_
+#define SRC_SCHEDULER_DETAIL_TIMING_WHEEL_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace fc
+{
+namespace thread
+{
+namespace detail
+{
+
+/**
+ * \brief hashed timing wheel for periodic entries.
+ *
+ * Every entry has a period given in ticks and is due whenever the absolute tick count
+ * is a multiple of its period. Entries are kept in the slot of their next due tick,
+ * thus advancing the wheel only touches entries in a single slot.
+ * Entries with periods longer than the wheel share slots with other entries,
+ * but are only reported once their due tick has been reached.
+ *
+ * The cost of a tick is independent of the number of entries which are not due,
+ * as long as the wheel has at least as many slots as the longest period.
+ */
+class timing_wheel
+{
+public:
+	using tick_t = uint64_t;
+
+	/// \pre nr_of_slots > 0
+	explicit timing_wheel(size_t nr_of_slots = 1024)
+		: slots(nr_of_slots)
+		, entries()
+		, current_tick(0)
+	{
+		assert(nr_of_slots > 0);
+	}
+
+	/**
+	 * \brief adds a new periodic entry with identifier id.
+	 * \pre period > 0
+	 * \post entry is due at the first multiple of period not before current().
+	 */
+	void add(size_t id, tick_t period)
+	{
+		assert(period > 0);
+		entries.push_back(entry{id, period, next_multiple(current_tick, period)});
+		insert(entries.size() - 1);
+	}
+
+	/// removes all entries \post empty()
+	void clear()
+	{
+		entries.clear();
+		for (auto& slot : slots)
+			slot.clear();
+	}
+
+	bool empty() const { return entries.empty(); }
+
+	/// the tick which will be processed by the next call to advance.
+	tick_t current() const { return current_tick; }
+
+	/**
+	 * \brief sets the current tick.
+	 * \post every entry is due at the first multiple of its period not before now.
+	 */
+	void reset(tick_t now)
+	{
+		current_tick = now;
+		for (auto& slot : slots)
+			slot.clear();
+		for (size_t i = 0; i != entries.size(); ++i)
+		{
+			entries[i].due = next_multiple(now, entries[i].period);
+			insert(i);
+		}
+	}
+
+	/// fills due_ids with the ids of all entries which are due at current().
+	void due_at_current(std::vector<size_t>& due_ids) const
+	{
+		due_ids.clear();
+		for (const size_t i : slots[current_tick % slots.size()])
+			if (entries[i].due == current_tick)
+				due_ids.push_back(entries[i].id);
+	}
+
+	/**
+	 * \brief processes current() and advances the wheel by a single tick.
+	 * \param due_ids is filled with the ids of all entries which are due at current().
+	 * \post current() is incremented by one.
+	 */
+	void advance(std::vector<size_t>& due_ids)
+	{
+		due_ids.clear();
+		auto& slot = slots[current_tick % slots.size()];
+		due_entries.clear();
+		size_t kept = 0;
+		for (const size_t i : slot)
+		{
+			if (entries[i].due == current_tick)
+				due_entries.push_back(i);
+			else
+				slot[kept++] = i;
+		}
+		slot.resize(kept);
+		for (const size_t i : due_entries)
+		{
+			entries[i].due += entries[i].period;
+			insert(i);
+			due_ids.push_back(entries[i].id);
+		}
+		++current_tick;
+	}
+
+	/**
+	 * \brief moves the wheel to tick without processing the ticks in between.
+	 * \pre current() <= tick <= next_due(), thus no entry is skipped.
+	 * \post current() == tick
+	 */
+	void skip_to(tick_t tick)
+	{
+		assert(current_tick <= tick);
+		assert(tick <= next_due());
+		current_tick = tick;
+	}
+
+	/// returns the earliest tick at which any entry is due, max of tick_t if empty.
+	tick_t next_due() const
+	{
+		tick_t next = std::numeric_limits<tick_t>::max();
+		for (const auto& e : entries)
+			next = std::min(next, e.due);
+		return next;
+	}
+
+private:
+	struct entry
+	{
+		size_t id;
+		tick_t period;
+		tick_t due;
+	};
+
+	/// smallest multiple of period which is not smaller than now
+	static tick_t next_multiple(tick_t now, tick_t period)
+	{
+		return (now + period - 1) / period * period;
+	}
+
+	void insert(size_t entry_index)
+	{
+		slots[entries[entry_index].due % slots.size()].push_back(entry_index);
+	}
+
+	/// indices into entries, sorted by due tick modulo the number of slots
+	std::vector<std::vector<size_t>> slots;
+	std::vector<entry> entries;
+	/// scratch storage for advance, kept to avoid allocations during ticks
+	std::vector<size_t> due_entries{};
+	tick_t current_tick;
+};
+
+} // namespace detail
+} // namespace thread
+} // namespace fc
+
+#endif /* SRC_SCHEDULER_DETAIL_TIMING_WHEEL_HPP_ */
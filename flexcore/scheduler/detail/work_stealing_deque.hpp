@@ -0,0 +1,170 @@
+#ifndef SRC_SCHEDULER_DETAIL_WORK_STEALING_DEQUE_HPP_
+#define SRC_SCHEDULER_DETAIL_WORK_STEALING_DEQUE_HPP_
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace fc
+{
+namespace thread
+{
+namespace detail
+{
+
+/**
+ * \brief lock-free work stealing deque after Chase and Lev.
+ *
+ * The owning thread pushes and pops at the bottom of the deque,
+ * all other threads may steal from the top.
+ * The memory orderings follow "Correct and Efficient Work-Stealing for Weak
+ * Memory Models" by Lê, Pop, Cohen and Zappa Nardelli.
+ *
+ * Arrays replaced during growth are kept alive until the deque is destroyed,
+ * since concurrent thieves might still read from them.
+ *
+ * \tparam T type of elements, needs to be trivially copyable. Usually a pointer.
+ * \remark push and pop may only be called by the owning thread.
+ */
+template<class T>
+class work_stealing_deque
+{
+	static_assert(std::is_trivially_copyable<T>{},
+			"work_stealing_deque can only store trivially copyable elements.");
+public:
+	/// \pre initial_capacity is a power of two
+	explicit work_stealing_deque(size_t initial_capacity = 256)
+		: top(0)
+		, bottom(0)
+		, array(nullptr)
+		, retired()
+	{
+		assert(initial_capacity > 0);
+		assert((initial_capacity & (initial_capacity - 1)) == 0);
+		retired.push_back(std::make_unique<ring>(initial_capacity));
+		array.store(retired.back().get(), std::memory_order_relaxed);
+	}
+
+	work_stealing_deque(const work_stealing_deque&) = delete;
+	work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+	/// adds element at the bottom, only to be called by the owner.
+	void push(T element)
+	{
+		const int64_t b = bottom.load(std::memory_order_relaxed);
+		const int64_t t = top.load(std::memory_order_acquire);
+		ring* a = array.load(std::memory_order_relaxed);
+		if (b - t > static_cast<int64_t>(a->capacity) - 1)
+			a = grow(a, t, b);
+		a->put(b, element);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+
+	/**
+	 * \brief takes element from the bottom, only to be called by the owner.
+	 * \return true if an element was written to out, false if the deque was empty.
+	 */
+	bool pop(T& out)
+	{
+		const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		ring* a = array.load(std::memory_order_relaxed);
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_relaxed);
+
+		if (t > b) // deque was empty
+		{
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		out = a->get(b);
+		if (t != b) // more than one element left, no race with thieves possible
+			return true;
+
+		// last element, race against thieves for it
+		const bool won = top.compare_exchange_strong(t, t + 1,
+				std::memory_order_seq_cst, std::memory_order_relaxed);
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return won;
+	}
+
+	/**
+	 * \brief takes element from the top, may be called by any thread.
+	 * \return true if an element was written to out,
+	 * false if the deque was empty or another thread won the race for the element.
+	 */
+	bool steal(T& out)
+	{
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64_t b = bottom.load(std::memory_order_acquire);
+		if (t >= b)
+			return false;
+
+		ring* a = array.load(std::memory_order_acquire);
+		const T element = a->get(t);
+		if (!top.compare_exchange_strong(t, t + 1,
+				std::memory_order_seq_cst, std::memory_order_relaxed))
+			return false;
+		out = element;
+		return true;
+	}
+
+	/// approximate number of elements, exact if no other thread accesses the deque.
+	size_t size() const
+	{
+		const int64_t b = bottom.load(std::memory_order_relaxed);
+		const int64_t t = top.load(std::memory_order_relaxed);
+		return b > t ? static_cast<size_t>(b - t) : 0;
+	}
+
+private:
+	/// circular array of atomic slots
+	struct ring
+	{
+		explicit ring(size_t cap)
+			: capacity(cap)
+			, slots(std::make_unique<std::atomic<T>[]>(cap))
+		{
+		}
+		T get(int64_t i) const
+		{
+			return slots[static_cast<size_t>(i) & (capacity - 1)].load(std::memory_order_relaxed);
+		}
+		void put(int64_t i, T element)
+		{
+			slots[static_cast<size_t>(i) & (capacity - 1)].store(element,
+					std::memory_order_relaxed);
+		}
+		const size_t capacity;
+		std::unique_ptr<std::atomic<T>[]> slots;
+	};
+
+	/// doubles the capacity, only called by owner.
+	ring* grow(ring* old, int64_t t, int64_t b)
+	{
+		retired.push_back(std::make_unique<ring>(old->capacity * 2));
+		ring* bigger = retired.back().get();
+		for (int64_t i = t; i != b; ++i)
+			bigger->put(i, old->get(i));
+		array.store(bigger, std::memory_order_release);
+		return bigger;
+	}
+
+	std::atomic<int64_t> top;
+	std::atomic<int64_t> bottom;
+	std::atomic<ring*> array;
+	/// all arrays ever used, owned here to keep them alive for late thieves.
+	std::vector<std::unique_ptr<ring>> retired;
+};
+
+} // namespace detail
+} // namespace thread
+} // namespace fc
+
+#endif /* SRC_SCHEDULER_DETAIL_WORK_STEALING_DEQUE_HPP_ */
@@ -0,0 +1,179 @@
+#ifndef SRC_SCHEDULER_LATENCY_HISTOGRAM_HPP_
+#define SRC_SCHEDULER_LATENCY_HISTOGRAM_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace fc
+{
+namespace thread
+{
+
+/**
+ * \brief copy of the content of a latency_histogram at a point in time.
+ *
+ * All durations are zero if no value has been recorded.
+ */
+struct latency_statistics
+{
+	using duration = std::chrono::nanoseconds;
+
+	uint64_t count = 0;
+	duration min = duration::zero();
+	duration max = duration::zero();
+	duration mean = duration::zero();
+	/// number of recorded values per bucket of the histogram
+	std::vector<uint64_t> buckets{};
+
+	/**
+	 * \brief approximate value below which the given percentage of recorded values lie.
+	 * \pre 0 <= p <= 100
+	 * \return upper bound of the bucket which contains the percentile,
+	 * clamped to [min, max].
+	 */
+	duration percentile(double p) const;
+};
+
+/**
+ * \brief lock-free histogram of durations with logarithmic buckets.
+ *
+ * Buckets are organized like in HdrHistogram:
+ * Every power of two range is split into sub_buckets linear buckets,
+ * which limits the relative error of a value to 1/sub_buckets.
+ * Durations are recorded in nanoseconds, values above max_exponent are put in the last bucket.
+ * Negative durations are recorded as zero.
+ *
+ * record may be called concurrently from any number of threads,
+ * it only uses relaxed atomic increments.
+ * Snapshots taken while values are recorded may be slightly inconsistent,
+ * i.e. count and bucket contents might differ by the values in flight.
+ */
+class latency_histogram
+{
+public:
+	using duration = std::chrono::nanoseconds;
+
+	/// log2 of the number of linear buckets per power of two
+	static constexpr unsigned sub_bucket_bits = 4;
+	static constexpr uint64_t sub_buckets = uint64_t(1) << sub_bucket_bits;
+	/// values up to 2^max_exponent nanoseconds (about 18 minutes) are resolved.
+	static constexpr unsigned max_exponent = 40;
+	static constexpr size_t nr_of_buckets =
+			sub_buckets + (max_exponent - sub_bucket_bits) * sub_buckets;
+
+	latency_histogram() { reset(); }
+	latency_histogram(const latency_histogram&) = delete;
+	latency_histogram& operator=(const latency_histogram&) = delete;
+
+	/// adds a value to the histogram, wait free apart from updating min and max.
+	void record(duration d) noexcept
+	{
+		const uint64_t value = static_cast<uint64_t>(std::max(d.count(), duration::rep(0)));
+		buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+		total_count.fetch_add(1, std::memory_order_relaxed);
+		sum.fetch_add(value, std::memory_order_relaxed);
+
+		uint64_t current_min = min_value.load(std::memory_order_relaxed);
+		while (value < current_min
+				&& !min_value.compare_exchange_weak(current_min, value, std::memory_order_relaxed))
+			;
+		uint64_t current_max = max_value.load(std::memory_order_relaxed);
+		while (value > current_max
+				&& !max_value.compare_exchange_weak(current_max, value, std::memory_order_relaxed))
+			;
+	}
+
+	/// returns a copy of the current content
+	latency_statistics snapshot() const
+	{
+		latency_statistics result;
+		result.count = total_count.load(std::memory_order_relaxed);
+		result.buckets.resize(nr_of_buckets);
+		for (size_t i = 0; i != nr_of_buckets; ++i)
+			result.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+		if (result.count == 0)
+			return result;
+
+		result.min = duration(min_value.load(std::memory_order_relaxed));
+		result.max = duration(max_value.load(std::memory_order_relaxed));
+		result.mean = duration(sum.load(std::memory_order_relaxed) / result.count);
+		return result;
+	}
+
+	/// removes all recorded values, not atomic with respect to concurrent calls to record.
+	void reset() noexcept
+	{
+		for (auto& b : buckets)
+			b.store(0, std::memory_order_relaxed);
+		total_count.store(0, std::memory_order_relaxed);
+		sum.store(0, std::memory_order_relaxed);
+		min_value.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+		max_value.store(0, std::memory_order_relaxed);
+	}
+
+	/// index of the bucket value is counted in
+	static size_t bucket_index(uint64_t value) noexcept
+	{
+		if (value < sub_buckets)
+			return static_cast<size_t>(value);
+		unsigned exponent = 0; // position of highest set bit
+		for (uint64_t v = value; v > 1; v >>= 1)
+			++exponent;
+		if (exponent >= max_exponent)
+			return nr_of_buckets - 1;
+		const uint64_t mantissa = (value >> (exponent - sub_bucket_bits)) & (sub_buckets - 1);
+		return static_cast<size_t>(
+				sub_buckets + (exponent - sub_bucket_bits) * sub_buckets + mantissa);
+	}
+
+	/// largest value counted in the bucket with the given index
+	static uint64_t bucket_upper_bound(size_t index) noexcept
+	{
+		assert(index < nr_of_buckets);
+		if (index < sub_buckets)
+			return index;
+		const uint64_t exponent = (index - sub_buckets) / sub_buckets + sub_bucket_bits;
+		const uint64_t mantissa = (index - sub_buckets) % sub_buckets;
+		const uint64_t width = uint64_t(1) << (exponent - sub_bucket_bits);
+		return (uint64_t(1) << exponent) + (mantissa + 1) * width - 1;
+	}
+
+private:
+	std::array<std::atomic<uint64_t>, nr_of_buckets> buckets;
+	std::atomic<uint64_t> total_count;
+	std::atomic<uint64_t> sum;
+	std::atomic<uint64_t> min_value;
+	std::atomic<uint64_t> max_value;
+};
+
+inline latency_statistics::duration latency_statistics::percentile(double p) const
+{
+	assert(p >= 0.0 && p <= 100.0);
+	if (count == 0)
+		return duration::zero();
+
+	const auto rank = static_cast<uint64_t>(std::ceil(p / 100.0 * count));
+	uint64_t seen = 0;
+	for (size_t i = 0; i != buckets.size(); ++i)
+	{
+		seen += buckets[i];
+		if (seen >= std::max<uint64_t>(rank, 1))
+		{
+			const duration bound(latency_histogram::bucket_upper_bound(i));
+			return std::min(std::max(bound, min), max);
+		}
+	}
+	return max;
+}
+
+} // namespace thread
+} // namespace fc
+
+#endif /* SRC_SCHEDULER_LATENCY_HISTOGRAM_HPP_ */
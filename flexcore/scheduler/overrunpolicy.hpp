@@ -0,0 +1,134 @@
+#ifndef SRC_SCHEDULER_OVERRUNPOLICY_HPP_
+#define SRC_SCHEDULER_OVERRUNPOLICY_HPP_
+
+#include "scheduler/clock.hpp"
+
+#include <cstdint>
+#include <limits>
+
+namespace fc
+{
+namespace thread
+{
+
+/// what a realtime main loop does with cycles, whose start time has already passed.
+enum class late_cycle_action
+{
+	/// runs the missed cycles back to back, until the loop is on time again.
+	catch_up,
+	/// drops the missed cycles, the virtual clock jumps over them.
+	skip,
+	/// starts the next cycle now, the virtual clock falls behind the wall clock.
+	stretch
+};
+
+/// counts of the decisions of an overrun_policy, see cycle_control::overrun_stats
+struct overrun_statistics
+{
+	/// number of cycles which started late by at least a tick
+	uint64_t late_cycles = 0;
+	/// number of late cycles run back to back to catch up
+	uint64_t caught_up_cycles = 0;
+	/// number of cycles which have been dropped
+	uint64_t skipped_ticks = 0;
+	/// number of late cycles, which were started late instead of being caught up
+	uint64_t stretched_cycles = 0;
+	/// number of times a due group has not been run to relieve the scheduler
+	uint64_t shed_groups = 0;
+	/// number of task runs left out, since the previous run of the task was not done
+	uint64_t skipped_tasks = 0;
+};
+
+/**
+ * \brief decides how cycle_control reacts to overload.
+ *
+ * The policy is asked by the realtime main loops when a cycle starts late by at least a tick
+ * and by cycle_control in overloaded cycles, i.e. cycles which started late
+ * or in which a due group still has running tasks.
+ * Tasks, which are not done when they are due again, are still reported to the
+ * timeout callback of cycle_control.
+ * Policies are only called from the main loop thread.
+ */
+class overrun_policy
+{
+public:
+	virtual ~overrun_policy() = default;
+
+	/**
+	 * \brief decides what to do with cycles which should have started already.
+	 * \param missed_ticks number of cycles whose start time has passed, at least one.
+	 */
+	virtual late_cycle_action late_cycle(uint64_t missed_ticks) = 0;
+
+	/**
+	 * \brief decides if a due group is left out in an overloaded cycle.
+	 * \param tick tick rate of the group
+	 * \param fastest tick rate of the fastest group of the cycle_control
+	 * \return true if the tasks of the group are not run in this cycle.
+	 */
+	virtual bool shed(virtual_clock::steady::duration /*tick*/,
+			virtual_clock::steady::duration /*fastest*/)
+	{
+		return false;
+	}
+};
+
+/**
+ * \brief runs missed cycles in a burst to catch up with the wall clock.
+ *
+ * If more than max_burst cycles have been missed, they are skipped instead.
+ * With the default unlimited burst, this is the behavior of cycle_control without a policy.
+ */
+class catch_up_policy : public overrun_policy
+{
+public:
+	explicit catch_up_policy(uint64_t max_burst = std::numeric_limits<uint64_t>::max())
+		: max_burst(max_burst)
+	{
+	}
+
+	late_cycle_action late_cycle(uint64_t missed_ticks) override
+	{
+		return missed_ticks <= max_burst ? late_cycle_action::catch_up : late_cycle_action::skip;
+	}
+
+private:
+	uint64_t max_burst;
+};
+
+/// drops missed cycles, the virtual time stays in sync with the wall clock.
+class skip_ticks_policy : public overrun_policy
+{
+public:
+	late_cycle_action late_cycle(uint64_t) override { return late_cycle_action::skip; }
+};
+
+/// stretches the late cycle, every tick is run, but the virtual time falls behind.
+class stretch_tick_policy : public overrun_policy
+{
+public:
+	late_cycle_action late_cycle(uint64_t) override { return late_cycle_action::stretch; }
+};
+
+/**
+ * \brief leaves out all groups slower than the fastest one in overloaded cycles.
+ *
+ * This keeps the latency of the fastest regions bounded during load spikes,
+ * missed cycles are dropped.
+ */
+class shed_slow_groups_policy : public overrun_policy
+{
+public:
+	late_cycle_action late_cycle(uint64_t) override { return late_cycle_action::skip; }
+
+	bool shed(virtual_clock::steady::duration tick,
+			virtual_clock::steady::duration fastest) override
+	{
+		return tick > fastest;
+	}
+};
+
+} // namespace thread
+} // namespace fc
+
+#endif /* SRC_SCHEDULER_OVERRUNPOLICY_HPP_ */
@@ -8,6 +8,8 @@
 #include "scheduler/parallelregion.hpp"
 #include "scheduler/cyclecontrol.hpp"
 
+#include <cassert>
+
 namespace fc
 {
 
@@ -16,6 +18,45 @@ bool operator ==(const region_id& lhs, const region_id& rhs)
 	return lhs.key == rhs.key;
 }
 
+constexpr size_t parallel_region::unordered;
+
+bool parallel_region::receives_handoff_from(const parallel_region& producer) const
+{
+	return wave != unordered && producer.wave != unordered
+			&& producer.wave < wave
+			&& producer.tick_duration == tick_duration;
+}
+
+void parallel_region::trigger_on_events(wall_clock::steady::duration min_interval)
+{
+	assert(min_interval > wall_clock::steady::duration::zero());
+	trigger_interval = min_interval;
+}
+
+void parallel_region::send_events_through_ring(const parallel_region& consumer,
+		event_ring_config config)
+{
+	for (auto& ring : event_rings)
+	{
+		if (ring.first == &consumer)
+		{
+			ring.second = config;
+			return;
+		}
+	}
+	event_rings.emplace_back(&consumer, config);
+}
+
+const event_ring_config* parallel_region::event_ring_to(const parallel_region& consumer) const
+{
+	for (const auto& ring : event_rings)
+	{
+		if (ring.first == &consumer)
+			return &ring.second;
+	}
+	return nullptr;
+}
+
 region_id parallel_region::get_id() const
 {
 	return id;
@@ -51,4 +92,9 @@ pure::event_source<void>& parallel_region::work_tick()
 	return ticks.work_tick();
 }
 
+pure::event_source<void>& parallel_region::work_done()
+{
+	return ticks.work_done();
+}
+
 } /* namespace fc */
@@ -8,11 +8,17 @@
 #ifndef SRC_SCHEDULER_PARALLELREGION_HPP_
 #define SRC_SCHEDULER_PARALLELREGION_HPP_
 
+#include "extended/ports/event_ring_config.hpp"
 #include "pure/event_sources.hpp"
 #include "scheduler/clock.hpp"
 
+#include <deque>
+#include <functional>
+#include <limits>
 #include <string>
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace fc
 {
@@ -26,6 +32,18 @@ struct region_id
 
 bool operator==(const region_id& lhs, const region_id& rhs);
 
+/// thread which exclusively executes a region, see parallel_region::run_on_dedicated_thread
+struct dedicated_thread_config
+{
+	/// cpus the thread is allowed to run on, empty if the thread is not pinned.
+	std::vector<int> cpus{};
+	/**
+	 * \brief busy wait for the next tick instead of blocking.
+	 * Lowers the start latency of the region, but occupies a cpu all the time.
+	 */
+	bool spin = false;
+};
+
 /**
  * \brief class providing the interface to cyclic ticks for nodes.
  */
@@ -41,6 +59,18 @@ public:
 	 * connect nodes, that want to be triggered every cycle to this.
 	 */
 	pure::event_source<void>& work_tick() { return work; }
+	/**
+	 * \brief creates a work tick for work, which is independent of all other work of the region.
+	 *
+	 * Every independent work tick is fired after the handlers of work_tick,
+	 * concurrently with the other independent work ticks if lane_executor is set.
+	 * The work of the region is only done once all of them are finished.
+	 */
+	pure::event_source<void>& independent_work_tick()
+	{
+		lanes.emplace_back();
+		return lanes.back();
+	}
 
 	/**
 	 * \brief Buffers in region will be switched when method is called.
@@ -52,10 +82,38 @@ public:
 	 * connect to scheduler.
 	 * expects event with no payload (void).
 	 */
-	auto in_work() { return [this](){ return work.fire(); };}
+	auto in_work() { return [this](){ work.fire(); fire_lanes(); };}
+
+	/// fires the independent work ticks with lane_executor, or one after another without it.
+	void fire_lanes()
+	{
+		if (lane_executor && lanes.size() > 1)
+			lane_executor(lanes.size(), [this](size_t lane) { lanes[lane].fire(); });
+		else
+			for (auto& lane : lanes)
+				lane.fire();
+	}
+	/// number of independent work ticks of the region
+	size_t nr_of_lanes() const { return lanes.size(); }
+
+	/**
+	 * \brief sends void event after the work tick of the surrounding region has finished.
+	 * Used to hand data to regions running later in the same cycle.
+	 */
+	pure::event_source<void>& work_done() { return work_done_; }
+	/// fires work_done, called by the scheduler once all work of the region is finished.
+	void finish_work() { work_done_.fire(); }
 
 	pure::event_source<void> switch_buffers_;
 	pure::event_source<void> work;
+	pure::event_source<void> work_done_;
+	/// independent work ticks, in a deque as nodes keep references to them
+	std::deque<pure::event_source<void>> lanes;
+	/**
+	 * \brief calls body for every index below count, possibly concurrently.
+	 * Returns once all calls are done, set by the scheduler which executes the region.
+	 */
+	std::function<void(size_t, const std::function<void(size_t)>&)> lane_executor{};
 };
 
 /**
@@ -85,13 +143,114 @@ public:
 	virtual_clock::steady::duration get_duration() const;
 	pure::event_source<void>& switch_tick();
 	pure::event_source<void>& work_tick();
+	/**
+	 * \brief work tick for work which may run concurrently with other independent work.
+	 * \see tick_controller::independent_work_tick
+	 */
+	pure::event_source<void>& independent_work_tick() { return ticks.independent_work_tick(); }
+	/// sends void event after all work of the region in the current cycle is finished.
+	pure::event_source<void>& work_done();
 	/// Create new region from existing one.
 	virtual std::shared_ptr<parallel_region> new_region(std::string name,
 	                                                    virtual_clock::steady::duration) const;
 
+	/**
+	 * \brief checks if data from producer reaches this region within the same cycle.
+	 *
+	 * This is the case if both regions have the same tick rate and are ordered by their
+	 * dependencies, with producer in an earlier wave. Otherwise data is double buffered
+	 * and arrives one cycle later.
+	 */
+	bool receives_handoff_from(const parallel_region& producer) const;
+
+	/// wave of regions which are not ordered by their dependencies
+	static constexpr size_t unordered = std::numeric_limits<size_t>::max();
+
 	tick_controller ticks;
 	region_id id;
 	const virtual_clock::steady::duration tick_duration;
+	/**
+	 * \brief position of the region in the dependency order of the regions with its tick rate.
+	 *
+	 * Within a cycle, regions of a wave only start once all regions of earlier waves
+	 * with the same tick rate are done.
+	 * Needs to be set before the scheduler is started, see infrastructure.
+	 */
+	size_t wave = unordered;
+
+	/**
+	 * \brief declares the expected execution time of a single cycle of this region.
+	 * Cheap regions may be fused into a single task, see cycle_control::set_fusion_budget.
+	 */
+	void declare_cost(wall_clock::steady::duration cost) { declared_cost_ = cost; }
+	/// declared execution time of a single cycle, zero if no cost was declared.
+	wall_clock::steady::duration declared_cost() const { return declared_cost_; }
+
+	/**
+	 * \brief lets the region be executed by a thread of its own.
+	 *
+	 * The thread is woken directly by cycle_control at the tick of the region,
+	 * so the region never waits behind other work in the queue of the scheduler.
+	 * Such regions are neither fused with others nor executed inline.
+	 * Needs to be set before the scheduler is started.
+	 */
+	void run_on_dedicated_thread(dedicated_thread_config config = {})
+	{
+		dedicated_config = std::move(config);
+		dedicated = true;
+	}
+	/// true if the region is executed by a thread of its own
+	bool has_dedicated_thread() const { return dedicated; }
+	/// configuration of the dedicated thread \pre has_dedicated_thread()
+	const dedicated_thread_config& dedicated_thread() const { return dedicated_config; }
+
+	/**
+	 * \brief lets the region run whenever events from other regions arrive, instead of on ticks.
+	 *
+	 * Buffers of connections to and from the region hand data over as soon as the producing
+	 * region is done with its work. Arrivals are coalesced into a single run of the region,
+	 * which starts at most once per min_interval. States read by the region are updated
+	 * whenever the region runs, but changing states don't trigger it.
+	 * \pre the region is neither connected nor added to a scheduler yet.
+	 * \pre min_interval > 0
+	 * \see infrastructure::add_triggered_region
+	 */
+	void trigger_on_events(wall_clock::steady::duration min_interval);
+	/// true if the region runs on arriving events, see trigger_on_events
+	bool is_event_triggered() const
+	{
+		return trigger_interval > wall_clock::steady::duration::zero();
+	}
+	/// minimum time between two starts of an event triggered region
+	wall_clock::steady::duration min_trigger_interval() const { return trigger_interval; }
+	/// signals that events for the region have arrived, called by the buffers of the region.
+	void data_arrived()
+	{
+		if (on_data_arrived)
+			on_data_arrived();
+	}
+	/// called on data_arrived, set by the scheduler of an event triggered region
+	std::function<void(void)> on_data_arrived{};
+
+	/**
+	 * \brief lets events sent from this region to consumer pass through a ring_event_buffer.
+	 *
+	 * The consumer receives the events on its next work tick without any switch tick,
+	 * and the memory of each buffer is bounded by the capacity of its ring.
+	 * Setting the ring again for the same consumer replaces the previous configuration.
+	 * \pre the region is not connected to consumer yet.
+	 */
+	void send_events_through_ring(const parallel_region& consumer, event_ring_config config = {});
+	/// configuration of the ring for events to consumer, nullptr if events are double buffered.
+	const event_ring_config* event_ring_to(const parallel_region& consumer) const;
+
+private:
+	wall_clock::steady::duration declared_cost_ = wall_clock::steady::duration::zero();
+	bool dedicated = false;
+	dedicated_thread_config dedicated_config{};
+	wall_clock::steady::duration trigger_interval = wall_clock::steady::duration::zero();
+	/// rings set by send_events_through_ring, by consumer, regions with equal ids are distinct
+	std::vector<std::pair<const parallel_region*, event_ring_config>> event_rings{};
 };
 
 } /* namespace fc */
@@ -1,5 +1,6 @@
 #include "scheduler/parallelscheduler.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <utility>
 
@@ -15,12 +16,30 @@ int parallel_scheduler::num_threads()
 	return nr;
 }
 
-parallel_scheduler::parallel_scheduler() :
+parallel_scheduler::parallel_scheduler(queue_order order_) :
+		parallel_scheduler(scheduler_config{}, order_)
+{
+}
+
+parallel_scheduler::parallel_scheduler(const scheduler_config& config_, queue_order order_) :
+		config(config_.workers.empty() ? scheduler_config::with_threads(num_threads()) : config_),
 		thread_pool(),
 		do_work(false),
-		task_queue()
+		order(order_),
+		task_queues(config.nr_of_groups() + 1)
 {
 	start();
+	try
+	{
+		for (size_t i = 0; i != thread_pool.size(); ++i)
+			if (!config.workers[i].cpus.empty())
+				set_affinity(thread_pool[i], config.workers[i].cpus);
+	}
+	catch (...)
+	{
+		stop();
+		throw;
+	}
 }
 
 
@@ -30,43 +49,58 @@ void parallel_scheduler::start() noexcept
 
 	//fill thread_pool in body of constructor,
 	//since otherwise threads would need to be copied
-	for (int i = 0, e = num_threads(); i != e; ++i)
+	for (const auto& worker : config.workers)
 	{
-		thread_pool.push_back(std::thread(
-				//infinite task loop for every thread,
-				//looks for tasks in task_queue and executes them
-				[this] ()
-				{
-					while (true)
-					{
-						task_t task;
-						{
-							queue_lock lock(task_queue_mutex);
-							// Wait while task_queue is empty and do_work is true.
-							// If do_work is false then exit loop. If task_queue is not empty, exit.
-							// Still need to check which condition is true after the while loop.
-							while (task_queue.empty() && do_work)
-								thread_control.wait(lock);
-
-							if (!do_work)
-								return;
-
-							// if we're here, then do_work must be true, and
-							// task_queue.empty() must be false.
-							assert(do_work);
-							assert(!task_queue.empty());
-
-							task = task_queue.front();
-							task_queue.pop();
-						}
-						if (task)
-							task();
-					}
-				}));
+		const int group = worker.group;
+		thread_pool.push_back(std::thread([this, group]() { work_loop(group); }));
 	}
 	assert(!thread_pool.empty()); //check invariant
 }
 
+void parallel_scheduler::work_loop(int group)
+{
+	//infinite task loop for every thread,
+	//looks for tasks in task_queues and executes them
+	while (true)
+	{
+		task_t task;
+		{
+			queue_lock lock(task_queue_mutex);
+			// Wait while there is no task for this worker and do_work is true.
+			// If do_work is false then exit loop. If there is a task, exit.
+			// Still need to check which condition is true after the while loop.
+			std::vector<queued_task>* queue = nullptr;
+			while ((queue = next_queue(group)) == nullptr && do_work)
+				thread_control.wait(lock);
+
+			if (!do_work)
+				return;
+
+			// if we're here, then do_work must be true, and
+			// there is a task for this worker.
+			assert(do_work);
+			assert(queue != nullptr);
+
+			std::pop_heap(begin(*queue), end(*queue), less_urgent);
+			task = std::move(queue->back().work);
+			queue->pop_back();
+		}
+		if (task)
+			task();
+	}
+}
+
+std::vector<parallel_scheduler::queued_task>* parallel_scheduler::next_queue(int group)
+{
+	auto& shared = task_queues.front();
+	auto& own = task_queues[group + 1];
+	if (own.empty())
+		return shared.empty() ? nullptr : &shared;
+	if (shared.empty())
+		return &own;
+	return less_urgent(shared.front(), own.front()) ? &own : &shared;
+}
+
 void parallel_scheduler::stop() noexcept
 {
 	//first stop the infinite loop in all threads
@@ -96,19 +130,67 @@ parallel_scheduler::~parallel_scheduler()
 size_t parallel_scheduler::nr_of_waiting_tasks() const
 {
 	queue_lock lock(task_queue_mutex);
-	return task_queue.size();
+	size_t waiting = 0;
+	for (const auto& queue : task_queues)
+		waiting += queue.size();
+	return waiting;
 }
 
 void parallel_scheduler::add_task(task_t new_task)
 {
+	add_task(std::move(new_task), scheduling_hints{});
+}
+
+void parallel_scheduler::add_task(task_t new_task, const scheduling_hints& hints)
+{
+	bool for_group = false;
 	{
 		queue_lock lock(task_queue_mutex);
-		task_queue.push(std::move(new_task));
+		for_group = enqueue(std::move(new_task), hints);
 	}
-	thread_control.notify_one();
+	// any worker can take a task without group,
+	// but only workers of the group a task for a group, which notify_one might miss.
+	if (for_group)
+		thread_control.notify_all();
+	else
+		thread_control.notify_one();
 	assert(!thread_pool.empty()); //check invariant
 }
 
+void parallel_scheduler::add_tasks(std::vector<scheduled_task>& new_tasks)
+{
+	if (new_tasks.empty())
+		return;
+
+	bool for_group = false;
+	{
+		queue_lock lock(task_queue_mutex);
+		for (auto& task : new_tasks)
+			for_group |= enqueue(std::move(task.work), task.hints);
+	}
+	// wake one worker per task, but not more than there are.
+	if (for_group || new_tasks.size() >= thread_pool.size())
+		thread_control.notify_all();
+	else
+		for (size_t i = 0; i != new_tasks.size(); ++i)
+			thread_control.notify_one();
+	new_tasks.clear();
+	assert(!thread_pool.empty()); //check invariant
+}
+
+bool parallel_scheduler::enqueue(task_t new_task, const scheduling_hints& hints)
+{
+	const bool for_group = hints.worker_group >= 0
+			&& hints.worker_group < static_cast<int>(task_queues.size()) - 1;
+	// in fifo order all tasks share the same deadline, thus only the sequence counts.
+	const auto deadline = order == queue_order::earliest_deadline_first
+			? hints.deadline : wall_clock::steady::time_point::max();
+	auto& queue = task_queues[for_group ? hints.worker_group + 1 : 0];
+	queue.push_back(queued_task{deadline, next_sequence++, std::move(new_task)});
+	std::push_heap(begin(queue), end(queue), less_urgent);
+	return for_group;
+}
+
 
 } /* namespace thread */
 } /* namespace fc */
@@ -2,12 +2,13 @@
 #define SRC_SCHEDULER_PARALLELSCHEDULER_HPP_
 
 #include "scheduler/scheduler.hpp"
+#include "scheduler/schedulerconfig.hpp"
 
-#include <thread>
-#include <vector>
-#include <queue>
 #include <condition_variable>
+#include <cstdint>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 namespace fc
 {
@@ -19,33 +20,98 @@ namespace thread
  *
  * Adds tasks a task queue. These tasks are then assigned to worker threads in a pool
  *
+ * By default the queue is ordered by the deadlines given in the scheduling_hints,
+ * thus workers always take the most urgent task (earliest deadline first).
+ * Tasks with equal deadlines, as well as tasks without deadline, are executed in the order
+ * they were added. Alternatively the deadlines can be ignored and all tasks executed in fifo order.
+ *
+ * The number of workers, their cpu affinity and their grouping can be set by a scheduler_config.
+ * Tasks with a worker_group in their scheduling_hints are only executed by workers of that group,
+ * tasks with an unknown group are treated like tasks without group.
+ *
  * \invariant thread_pool.size() > 0
  */
 class parallel_scheduler : public scheduler
 {
 public:
+	/// order in which queued tasks are handed to the worker threads
+	enum class queue_order
+	{
+		fifo,
+		earliest_deadline_first
+	};
+
 	static int num_threads();
 
-	parallel_scheduler();
+	/// creates num_threads() unpinned workers
+	explicit parallel_scheduler(queue_order order = queue_order::earliest_deadline_first);
+	/**
+	 * \brief creates workers as given in config.
+	 * If config contains no workers, num_threads() unpinned workers are created.
+	 * \throws std::invalid_argument if a worker is pinned to an invalid cpu index.
+	 * \throws std::system_error if the affinity of a worker cannot be set.
+	 */
+	explicit parallel_scheduler(const scheduler_config& config,
+			queue_order order = queue_order::earliest_deadline_first);
 	parallel_scheduler(const parallel_scheduler&) = delete;
 	~parallel_scheduler() override;
 
+	using scheduler::add_task;
 	///adds a new task and notifies waiting threads.
 	void add_task(task_t new_task) override;
+	///adds a new task with a deadline and worker group and notifies waiting threads.
+	void add_task(task_t new_task, const scheduling_hints& hints) override;
+	///adds all tasks with a single lock of the queue and wakes as many threads as needed.
+	void add_tasks(std::vector<scheduled_task>& new_tasks) override;
 	/// stops the work loop of all threads
 	void stop() noexcept override;
 	size_t nr_of_waiting_tasks() const override;
 
+	/// returns the number of worker threads in the pool.
+	int nr_of_threads() const { return static_cast<int>(thread_pool.size()); }
+
 private:
 	/// startes the work loop of all threads
 	void start() noexcept;
+	/// work loop of a worker thread of the given group
+	void work_loop(int group);
+
+	struct queued_task
+	{
+		wall_clock::steady::time_point deadline;
+		/// order of insertion, breaks ties between equal deadlines
+		uint64_t sequence;
+		task_t work;
+	};
+	/// orders queued_tasks in a heap, such that the most urgent task is on top.
+	static bool less_urgent(const queued_task& a, const queued_task& b)
+	{
+		if (a.deadline != b.deadline)
+			return a.deadline > b.deadline;
+		return a.sequence > b.sequence;
+	}
+	/**
+	 * \brief puts a task in the queue of its group.
+	 * \pre task_queue_mutex is locked.
+	 * \return true if the task is bound to a worker group.
+	 */
+	bool enqueue(task_t new_task, const scheduling_hints& hints);
+	/// queue holding the tasks a worker of group may take next, nullptr if there are none.
+	std::vector<queued_task>* next_queue(int group);
 
+	const scheduler_config config;
 	std::vector<std::thread> thread_pool;
 	bool do_work; ///< flag indicates threads to keep working.
+	const queue_order order;
 
-	// current implementation is simple and based on locking the task_queue,
+	// current implementation is simple and based on locking the task_queues,
 	//might be worthwhile exchanging it for a lockfree one.
-	std::queue<task_t> task_queue;
+	/**
+	 * binary heaps ordered by less_urgent,
+	 * the first one holds tasks for any worker, followed by one heap per worker group.
+	 */
+	std::vector<std::vector<queued_task>> task_queues;
+	uint64_t next_sequence = 0;
 	mutable std::mutex task_queue_mutex;
 	using queue_lock = std::unique_lock<std::mutex>;
 	///used to notify worker threads if new tasks are available
@@ -1,17 +1,68 @@
 #ifndef SRC_THREADING_SCHEDULER_HPP_
 #define SRC_THREADING_SCHEDULER_HPP_
 
+#include "scheduler/clock.hpp"
+
+#include <cstddef>
 #include <functional>
+#include <utility>
+#include <vector>
 
 namespace fc
 {
 namespace thread
 {
+
+/// worker group of tasks which may be executed by any worker
+constexpr int any_worker_group = -1;
+
+/**
+ * \brief additional information about a task, which schedulers may use to order tasks.
+ *
+ * Schedulers are free to ignore hints.
+ */
+struct scheduling_hints
+{
+	/// point in time by which the task should be finished, tasks without a deadline never expire.
+	wall_clock::steady::time_point deadline = wall_clock::steady::time_point::max();
+	/// group of workers which should execute the task, see scheduler_config.
+	int worker_group = any_worker_group;
+};
+
+/// a task together with its scheduling_hints, used to add many tasks at once.
+struct scheduled_task
+{
+	std::function<void(void)> work;
+	scheduling_hints hints{};
+};
+
 class scheduler
 {
 public:
 	using task_t = std::function<void(void)>;
 	virtual void add_task(task_t new_task) = 0;
+	/**
+	 * \brief adds a task together with hints on how urgent it is.
+	 * The default implementation ignores the hints and calls add_task(new_task).
+	 */
+	virtual void add_task(task_t new_task, const scheduling_hints& hints)
+	{
+		static_cast<void>(hints);
+		add_task(std::move(new_task));
+	}
+	/**
+	 * \brief adds all tasks in new_tasks at once.
+	 *
+	 * Schedulers should override this to synchronize only once for the whole batch.
+	 * The default implementation calls add_task for every task.
+	 * \post new_tasks is empty, its capacity is kept to be reused for the next batch.
+	 */
+	virtual void add_tasks(std::vector<scheduled_task>& new_tasks)
+	{
+		for (auto& task : new_tasks)
+			add_task(std::move(task.work), task.hints);
+		new_tasks.clear();
+	}
 	virtual void stop() = 0;
 	virtual size_t nr_of_waiting_tasks() const = 0;
 	virtual ~scheduler() = default;
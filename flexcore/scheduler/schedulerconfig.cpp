@@ -0,0 +1,132 @@
+#include "scheduler/schedulerconfig.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace fc
+{
+namespace thread
+{
+
+int scheduler_config::nr_of_groups() const
+{
+	int groups = 0;
+	for (const auto& worker : workers)
+		groups = std::max(groups, worker.group + 1);
+	return groups;
+}
+
+scheduler_config scheduler_config::with_threads(int nr_of_threads)
+{
+	if (nr_of_threads <= 0)
+		throw std::invalid_argument{"a scheduler needs at least one thread"};
+	scheduler_config config;
+	config.workers.resize(nr_of_threads);
+	return config;
+}
+
+scheduler_config scheduler_config::pinned(const std::vector<int>& cpus)
+{
+	scheduler_config config;
+	for (const int cpu : cpus)
+		config.workers.push_back(worker_config{{cpu}, 0});
+	return config;
+}
+
+scheduler_config scheduler_config::per_numa_node(int threads_per_node)
+{
+	if (threads_per_node < 0)
+		throw std::invalid_argument{"the number of threads per node can't be negative"};
+	scheduler_config config;
+	const auto nodes = numa_nodes();
+	for (size_t group = 0; group != nodes.size(); ++group)
+	{
+		const auto& cpus = nodes[group].cpus;
+		const int nr_of_threads = threads_per_node > 0
+				? threads_per_node : static_cast<int>(cpus.size());
+		for (int i = 0; i != nr_of_threads; ++i)
+			config.workers.push_back(worker_config{cpus, static_cast<int>(group)});
+	}
+	return config;
+}
+
+std::vector<int> parse_cpu_list(const std::string& list)
+{
+	std::vector<int> cpus;
+	std::istringstream stream(list);
+	std::string range;
+	while (std::getline(stream, range, ','))
+	{
+		if (range.find_first_not_of(" \t\n") == std::string::npos)
+			continue;
+		const auto dash = range.find('-');
+		const int first = std::stoi(range.substr(0, dash));
+		const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+		for (int cpu = first; cpu <= last; ++cpu)
+			cpus.push_back(cpu);
+	}
+	return cpus;
+}
+
+namespace
+{
+/// first line of a file in sysfs, empty if the file can't be read.
+std::string read_sysfs_line(const std::string& path)
+{
+	std::ifstream file(path);
+	std::string line;
+	if (file)
+		std::getline(file, line);
+	return line;
+}
+} // anonymous namespace
+
+std::vector<numa_node> numa_nodes()
+{
+	const std::string sysfs_nodes = "/sys/devices/system/node/";
+	std::vector<numa_node> nodes;
+	// online node ids may have gaps, e.g. "0-1,4"
+	for (const int id : parse_cpu_list(read_sysfs_line(sysfs_nodes + "online")))
+	{
+		auto cpus = parse_cpu_list(
+				read_sysfs_line(sysfs_nodes + "node" + std::to_string(id) + "/cpulist"));
+		// nodes without cpus (memory only) can't run workers.
+		if (!cpus.empty())
+			nodes.push_back(numa_node{id, std::move(cpus)});
+	}
+
+	if (nodes.empty())
+	{
+		const int nr_of_cpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+		nodes.emplace_back();
+		for (int cpu = 0; cpu != nr_of_cpus; ++cpu)
+			nodes.back().cpus.push_back(cpu);
+	}
+	return nodes;
+}
+
+void set_affinity(std::thread& thread, const std::vector<int>& cpus)
+{
+	assert(!cpus.empty());
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (const int cpu : cpus)
+	{
+		if (cpu < 0 || cpu >= CPU_SETSIZE)
+			throw std::invalid_argument{"invalid cpu index " + std::to_string(cpu)};
+		CPU_SET(cpu, &set);
+	}
+	const int error = pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+	if (error != 0)
+		throw std::system_error(error, std::system_category(), "setting thread affinity failed");
+}
+
+} // namespace thread
+} // namespace fc
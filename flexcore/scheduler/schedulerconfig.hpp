@@ -0,0 +1,92 @@
+#ifndef SRC_SCHEDULER_SCHEDULERCONFIG_HPP_
+#define SRC_SCHEDULER_SCHEDULERCONFIG_HPP_
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fc
+{
+namespace thread
+{
+
+/// configuration of a single worker thread of a scheduler
+struct worker_config
+{
+	/// cpus the worker is allowed to run on, empty if the worker is not pinned.
+	std::vector<int> cpus{};
+	/**
+	 * \brief group the worker belongs to.
+	 * Tasks bound to a group are only executed by workers of that group,
+	 * all other tasks by any worker.
+	 */
+	int group = 0;
+};
+
+/**
+ * \brief configuration of the worker threads of a scheduler.
+ *
+ * An empty configuration stands for the default of the scheduler,
+ * usually one unpinned worker per hardware thread.
+ */
+struct scheduler_config
+{
+	std::vector<worker_config> workers{};
+
+	/// number of worker groups, i.e. largest group index + 1.
+	int nr_of_groups() const;
+
+	/**
+	 * \brief nr_of_threads unpinned workers in group 0.
+	 * \pre nr_of_threads > 0, otherwise std::invalid_argument is thrown.
+	 */
+	static scheduler_config with_threads(int nr_of_threads);
+	/// one worker per cpu in cpus, pinned to that cpu, all in group 0.
+	static scheduler_config pinned(const std::vector<int>& cpus);
+	/**
+	 * \brief workers grouped by NUMA node.
+	 *
+	 * Every node in numa_nodes() gets its own group, group i belongs to numa_nodes()[i],
+	 * which is not necessarily NUMA node i, see numa_node::id.
+	 * The workers of a group may run on all cpus of their node.
+	 * \param threads_per_node number of workers per node,
+	 * 0 creates one worker per cpu of the node.
+	 * \pre threads_per_node >= 0, otherwise std::invalid_argument is thrown.
+	 */
+	static scheduler_config per_numa_node(int threads_per_node = 0);
+};
+
+/// NUMA node of the system, which has cpus.
+struct numa_node
+{
+	/// index of the node used by the kernel, like 1 for /sys/devices/system/node/node1.
+	int id = 0;
+	std::vector<int> cpus{};
+};
+
+/**
+ * \brief online NUMA nodes of the system, which have cpus, ordered by their id.
+ *
+ * Read from sysfs. Node ids may have gaps, as nodes can be offline or without cpus.
+ * If sysfs is not available all cpus are reported as a single node with id 0.
+ */
+std::vector<numa_node> numa_nodes();
+
+/**
+ * \brief parses a list of cpus in the format of the linux kernel, like "0-3,8,10-11".
+ * Lists of NUMA nodes, like /sys/devices/system/node/online, have the same format.
+ */
+std::vector<int> parse_cpu_list(const std::string& list);
+
+/**
+ * \brief restricts the thread to the given cpus.
+ * \pre cpus is not empty
+ * \throws std::invalid_argument if a cpu index is negative or too large for a cpu set.
+ * \throws std::system_error if the affinity cannot be set.
+ */
+void set_affinity(std::thread& thread, const std::vector<int>& cpus);
+
+} // namespace thread
+} // namespace fc
+
+#endif /* SRC_SCHEDULER_SCHEDULERCONFIG_HPP_ */
@@ -1,30 +1,83 @@
 #include "scheduler/serialschedulers.hpp"
 
+#include <cassert>
+
 namespace fc
 {
 namespace thread
 {
 
+namespace
+{
+/// counts tasks as unfinished until they are finished or the counter goes out of scope.
+class unfinished_tasks
+{
+public:
+	unfinished_tasks(std::atomic<size_t>& counter, size_t nr_of_tasks)
+		: counter(counter), remaining(nr_of_tasks)
+	{
+		counter.fetch_add(nr_of_tasks);
+	}
+	unfinished_tasks(const unfinished_tasks&) = delete;
+	unfinished_tasks& operator=(const unfinished_tasks&) = delete;
+	/// tasks, which threw, are no longer unfinished either.
+	~unfinished_tasks() { counter.fetch_sub(remaining); }
+
+	void finish_one()
+	{
+		assert(remaining > 0);
+		--remaining;
+		counter.fetch_sub(1);
+	}
+
+private:
+	std::atomic<size_t>& counter;
+	size_t remaining;
+};
+} // anonymous namespace
+
 void blocking_scheduler::add_task(task_t new_task)
 {
-	std::lock_guard<std::mutex> lock(mutex);
+	std::lock_guard<std::recursive_mutex> lock(mutex);
 	if (stopped)
 		throw std::runtime_error{"attempting to add a task to stopped scheduler."};
+	unfinished_tasks unfinished{unfinished_count, 1};
 	new_task();
 }
 
+void blocking_scheduler::add_tasks(std::vector<scheduled_task>& new_tasks)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	if (stopped)
+		throw std::runtime_error{"attempting to add a task to stopped scheduler."};
+	unfinished_tasks unfinished{unfinished_count, new_tasks.size()};
+	auto next = new_tasks.begin();
+	try
+	{
+		for (; next != new_tasks.end(); ++next)
+		{
+			next->work();
+			unfinished.finish_one();
+		}
+	}
+	catch (...)
+	{
+		// the failed task has run as well, only the tasks behind it are left
+		new_tasks.erase(new_tasks.begin(), next + 1);
+		throw;
+	}
+	new_tasks.clear();
+}
+
 void blocking_scheduler::stop()
 {
-	std::lock_guard<std::mutex> lock(mutex);
+	std::lock_guard<std::recursive_mutex> lock(mutex);
 	stopped = true;
 }
 
 size_t blocking_scheduler::nr_of_waiting_tasks() const
 {
-	if (!mutex.try_lock())
-		return 1;
-	mutex.unlock();
-	return 0;
+	return unfinished_count.load();
 }
 
 blocking_scheduler::~blocking_scheduler()
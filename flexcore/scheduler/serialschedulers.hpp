@@ -2,6 +2,7 @@
 #define SRC_THREADING_SERIALSCHEDULER_HPP_
 
 #include "scheduler/scheduler.hpp"
+#include <atomic>
 #include <mutex>
 
 namespace fc
@@ -12,15 +13,30 @@ namespace thread
 class blocking_scheduler : public scheduler
 {
 public:
+	using scheduler::add_task;
 	void add_task(task_t new_task) override;
+	/**
+	 * \brief executes all tasks in order while holding the lock only once.
+	 *
+	 * Tasks are consumed as they run. If a task throws, it and all tasks before it
+	 * are removed from new_tasks, the tasks after it remain and have not been executed.
+	 */
+	void add_tasks(std::vector<scheduled_task>& new_tasks) override;
 	void stop() override;
+	/**
+	 * \brief number of added tasks, which haven't finished yet.
+	 * Includes the task calling it and the tasks behind it in a batch of add_tasks.
+	 */
 	size_t nr_of_waiting_tasks() const override;
 	~blocking_scheduler() override;
 
 	blocking_scheduler() = default;
 private:
-	mutable std::mutex mutex;
+	/// recursive, as tasks may add further tasks, which are executed right away.
+	std::recursive_mutex mutex;
 	bool stopped = false;
+	/// tasks added and not finished yet, readable without the lock, even from within tasks.
+	std::atomic<size_t> unfinished_count{0};
 };
 } /* namespace thread */
 } /* namespace fc */
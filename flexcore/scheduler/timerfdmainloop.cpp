@@ -0,0 +1,85 @@
+#include "scheduler/timerfdmainloop.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <system_error>
+
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace fc
+{
+namespace thread
+{
+
+namespace
+{
+/**
+ * converts a time point of wall_clock::steady to a timespec of CLOCK_MONOTONIC.
+ * std::chrono::steady_clock is based on CLOCK_MONOTONIC on linux.
+ */
+timespec to_timespec(wall_clock::steady::time_point t)
+{
+	const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			t.time_since_epoch()).count();
+	timespec result{};
+	result.tv_sec = static_cast<time_t>(ns / 1000000000);
+	result.tv_nsec = static_cast<long>(ns % 1000000000);
+	return result;
+}
+
+}
+
+timerfd_main_loop::timerfd_main_loop(wall_clock::steady::duration spin_)
+	: timer_fd(timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC))
+	, spin(spin_)
+{
+	assert(spin >= wall_clock::steady::duration::zero());
+	if (timer_fd < 0)
+		throw std::system_error(errno, std::system_category(), "timerfd_create failed");
+}
+
+timerfd_main_loop::~timerfd_main_loop()
+{
+	close(timer_fd);
+}
+
+void timerfd_main_loop::loop_body(const std::function<void(void)>& work)
+{
+	epoch = handle_late_start(epoch);
+	epoch += tick_length;
+	work();
+	wait_until(epoch);
+}
+
+void timerfd_main_loop::wait_until(wall_clock::steady::time_point deadline)
+{
+	const auto wakeup = deadline - spin;
+	if (wakeup > wall_clock::steady::now())
+	{
+		itimerspec timer{};
+		timer.it_value = to_timespec(wakeup);
+		if (timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &timer, nullptr) != 0)
+			throw std::system_error(errno, std::system_category(), "timerfd_settime failed");
+
+		uint64_t expirations = 0;
+		while (read(timer_fd, &expirations, sizeof(expirations)) < 0)
+		{
+			if (errno != EINTR)
+				throw std::system_error(errno, std::system_category(), "reading timerfd failed");
+		}
+	}
+
+	auto now = wall_clock::steady::now();
+	while (now < deadline)
+	{
+		detail::cpu_relax();
+		now = wall_clock::steady::now();
+	}
+	lateness_histogram.record(now - deadline);
+}
+
+} // namespace thread
+} // namespace fc
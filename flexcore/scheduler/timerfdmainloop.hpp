@@ -0,0 +1,67 @@
+#ifndef SRC_SCHEDULER_TIMERFDMAINLOOP_HPP_
+#define SRC_SCHEDULER_TIMERFDMAINLOOP_HPP_
+
+#include "scheduler/cyclecontrol.hpp"
+#include "scheduler/latency_histogram.hpp"
+
+namespace fc
+{
+namespace thread
+{
+
+/**
+ * \brief Main Loop which runs in realtime with low wakeup jitter.
+ *
+ * Like realtime_main_loop, but waits for the start of the next cycle on a
+ * linux timerfd armed with an absolute deadline on the monotonic clock,
+ * which avoids the drift and most of the jitter of sleeping for a relative duration.
+ * If a spin duration is given, the timer is armed that much earlier
+ * and the remaining time until the deadline is spent busy waiting.
+ * This trades cpu time of the main loop thread for lower lateness.
+ *
+ * The lateness of every wakeup relative to its deadline is recorded
+ * and can be queried at any time, also while the loop is running.
+ *
+ * Only available on linux.
+ */
+class timerfd_main_loop final : public main_loop
+{
+public:
+	/**
+	 * \param spin duration before each deadline which is spent busy waiting.
+	 * \pre spin >= 0
+	 * \throws std::system_error if the timer cannot be created.
+	 */
+	explicit timerfd_main_loop(
+			wall_clock::steady::duration spin = wall_clock::steady::duration::zero());
+	~timerfd_main_loop() override;
+
+	timerfd_main_loop(const timerfd_main_loop&) = delete;
+	timerfd_main_loop& operator=(const timerfd_main_loop&) = delete;
+
+	void loop_body(const std::function<void(void)>& work) override;
+
+	void arm() override { epoch = wall_clock::steady::now(); }
+
+	/// duration spent busy waiting before each deadline
+	wall_clock::steady::duration spin_duration() const { return spin; }
+
+	/// statistics of the lateness of all ticks since construction or the last reset.
+	latency_statistics lateness() const { return lateness_histogram.snapshot(); }
+	/// discards all recorded lateness values.
+	void reset_lateness() { lateness_histogram.reset(); }
+
+private:
+	/// blocks until deadline has passed
+	void wait_until(wall_clock::steady::time_point deadline);
+
+	int timer_fd;
+	wall_clock::steady::duration spin;
+	wall_clock::steady::time_point epoch{wall_clock::steady::now()};
+	latency_histogram lateness_histogram{};
+};
+
+} // namespace thread
+} // namespace fc
+
+#endif /* SRC_SCHEDULER_TIMERFDMAINLOOP_HPP_ */
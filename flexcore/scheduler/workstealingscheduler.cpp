@@ -0,0 +1,200 @@
+#include "scheduler/workstealingscheduler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace fc
+{
+namespace thread
+{
+namespace
+{
+/// identifies the worker the current thread belongs to, if any.
+struct worker_identity
+{
+	const work_stealing_scheduler* owner;
+	size_t index;
+};
+thread_local worker_identity current_worker{nullptr, 0};
+
+/// number of times an idle worker looks for tasks again before it goes to sleep.
+constexpr int spin_rounds = 64;
+
+uint32_t next_random(uint32_t& state)
+{
+	// xorshift32, good enough to spread thieves over victims
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+}
+
+work_stealing_scheduler::work_stealing_scheduler()
+	: work_stealing_scheduler(static_cast<int>(
+			std::max(1u, std::thread::hardware_concurrency())))
+{
+}
+
+work_stealing_scheduler::work_stealing_scheduler(int nr_of_threads)
+	: workers()
+	, injected()
+	, do_work(true)
+	, waiting_tasks(0)
+	, sleeping_workers(0)
+	, sleep_mutex()
+	, wake_up()
+{
+	assert(nr_of_threads > 0);
+	// create all workers before starting the threads,
+	// as every thread might access the deques of all other workers.
+	for (int i = 0; i != nr_of_threads; ++i)
+	{
+		workers.push_back(std::make_unique<worker>());
+		workers.back()->random_state = static_cast<uint32_t>(i) + 1;
+	}
+	for (size_t i = 0; i != workers.size(); ++i)
+		workers[i]->thread = std::thread([this, i]() { work_loop(i); });
+	assert(!workers.empty()); //check invariant
+}
+
+work_stealing_scheduler::~work_stealing_scheduler()
+{
+	//first stop all threads, destroying running threads is illegal
+	stop();
+
+	// delete tasks which have never been started
+	task_t* task = nullptr;
+	for (auto& w : workers)
+		while (w->tasks.pop(task))
+			delete task;
+	while (injected.try_pop(task))
+		delete task;
+}
+
+void work_stealing_scheduler::add_task(task_t new_task)
+{
+	auto task = std::make_unique<task_t>(std::move(new_task));
+	// count before pushing, otherwise the counter could underflow
+	// if a worker takes and starts the task immediately.
+	waiting_tasks.fetch_add(1);
+
+	if (current_worker.owner == this)
+	{
+		workers[current_worker.index]->tasks.push(task.release());
+	}
+	else
+	{
+		while (!injected.try_push(task.get()))
+		{
+			if (!do_work.load())
+			{
+				waiting_tasks.fetch_sub(1);
+				return;
+			}
+			std::this_thread::yield();
+		}
+		task.release();
+	}
+	wake_one();
+}
+
+void work_stealing_scheduler::stop() noexcept
+{
+	{
+		//Acquire lock first, so no worker can go to sleep while we set the flag.
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		do_work.store(false);
+	}
+	wake_up.notify_all();
+	for (auto& w : workers)
+	{
+		if (w->thread.joinable())
+			w->thread.join();
+	}
+	assert(!workers.empty()); //check invariant
+}
+
+size_t work_stealing_scheduler::nr_of_waiting_tasks() const
+{
+	return waiting_tasks.load();
+}
+
+void work_stealing_scheduler::work_loop(size_t index)
+{
+	current_worker = worker_identity{this, index};
+	while (do_work.load())
+	{
+		task_t* task = nullptr;
+		for (int i = 0; i != spin_rounds && !task && do_work.load(); ++i)
+		{
+			task = find_task(index);
+			if (!task)
+				std::this_thread::yield();
+		}
+
+		if (task)
+			run(task);
+		else
+			park();
+	}
+}
+
+work_stealing_scheduler::task_t* work_stealing_scheduler::find_task(size_t index)
+{
+	worker& self = *workers[index];
+	task_t* task = nullptr;
+	if (self.tasks.pop(task))
+		return task;
+	if (injected.try_pop(task))
+		return task;
+
+	const size_t nr_workers = workers.size();
+	const size_t first_victim = next_random(self.random_state) % nr_workers;
+	for (size_t i = 0; i != nr_workers; ++i)
+	{
+		const size_t victim = (first_victim + i) % nr_workers;
+		if (victim != index && workers[victim]->tasks.steal(task))
+			return task;
+	}
+	return nullptr;
+}
+
+void work_stealing_scheduler::park()
+{
+	std::unique_lock<std::mutex> lock(sleep_mutex);
+	// sleeping_workers is incremented before checking for tasks
+	// and add_task increments waiting_tasks before checking for sleepers.
+	// Thus at least one of both sees the change of the other and no wakeup is lost.
+	sleeping_workers.fetch_add(1);
+	wake_up.wait(lock, [this]()
+	{
+		return !do_work.load() || waiting_tasks.load() > 0;
+	});
+	sleeping_workers.fetch_sub(1);
+}
+
+void work_stealing_scheduler::wake_one()
+{
+	if (sleeping_workers.load() == 0)
+		return;
+	{
+		// lock to make sure the sleeper is either waiting already
+		// or has not yet checked for waiting tasks.
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+	}
+	wake_up.notify_one();
+}
+
+void work_stealing_scheduler::run(task_t* task)
+{
+	assert(task);
+	std::unique_ptr<task_t> owned_task{task};
+	waiting_tasks.fetch_sub(1);
+	if (*owned_task)
+		(*owned_task)();
+}
+
+} /* namespace thread */
+} /* namespace fc */
@@ -0,0 +1,96 @@
+#ifndef SRC_SCHEDULER_WORKSTEALINGSCHEDULER_HPP_
+#define SRC_SCHEDULER_WORKSTEALINGSCHEDULER_HPP_
+
+#include "scheduler/scheduler.hpp"
+#include "scheduler/detail/injection_queue.hpp"
+#include "scheduler/detail/work_stealing_deque.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fc
+{
+namespace thread
+{
+
+/**
+ * \brief scheduler based on a threadpool with work stealing.
+ *
+ * Every worker thread owns a lock-free deque of tasks.
+ * Tasks added from a worker thread of this scheduler are pushed to the deque of that worker,
+ * tasks added from any other thread (like the main loop of cycle_control)
+ * are pushed to a lock-free injection queue shared by all workers.
+ * Idle workers take tasks from their own deque first, then from the injection queue
+ * and finally steal from the deques of the other workers.
+ *
+ * Workers which do not find any work park on a condition variable.
+ * The mutex guarding it is only touched if a worker actually sleeps,
+ * thus add_task does not lock as long as all workers are busy.
+ *
+ * Deadlines in scheduling_hints are ignored, tasks are taken in roughly fifo order.
+ *
+ * \invariant workers.size() > 0
+ */
+class work_stealing_scheduler : public scheduler
+{
+public:
+	/// creates one worker thread per hardware thread.
+	work_stealing_scheduler();
+	/**
+	 * \param nr_of_threads number of worker threads in the pool
+	 * \pre nr_of_threads > 0
+	 */
+	explicit work_stealing_scheduler(int nr_of_threads);
+	work_stealing_scheduler(const work_stealing_scheduler&) = delete;
+	~work_stealing_scheduler() override;
+
+	using scheduler::add_task;
+	/**
+	 * \brief adds a new task and wakes up a sleeping worker if there is one.
+	 *
+	 * If the injection queue is full, the calling thread yields until a worker made room.
+	 */
+	void add_task(task_t new_task) override;
+	/// stops the work loop of all threads, tasks which have not been started are discarded.
+	void stop() noexcept override;
+	size_t nr_of_waiting_tasks() const override;
+
+	/// returns the number of worker threads in the pool.
+	int nr_of_threads() const { return static_cast<int>(workers.size()); }
+
+private:
+	struct worker
+	{
+		detail::work_stealing_deque<task_t*> tasks{};
+		std::thread thread{};
+		/// state of xorshift random generator used to choose victims for stealing.
+		uint32_t random_state = 0;
+	};
+
+	void work_loop(size_t index);
+	/// looks for a task in own deque, injection queue and deques of others, in this order.
+	task_t* find_task(size_t index);
+	/// blocks calling worker until new tasks are available or scheduler is stopped.
+	void park();
+	void wake_one();
+	void run(task_t* task);
+
+	std::vector<std::unique_ptr<worker>> workers;
+	detail::injection_queue<task_t*> injected;
+	std::atomic<bool> do_work;
+	/// number of tasks which have been added but not yet started
+	std::atomic<size_t> waiting_tasks;
+	std::atomic<int> sleeping_workers;
+	std::mutex sleep_mutex;
+	std::condition_variable wake_up;
+};
+
+} /* namespace thread */
+} /* namespace fc */
+
+#endif /* SRC_SCHEDULER_WORKSTEALINGSCHEDULER_HPP_ */
@@ -86,4 +86,57 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(test_graph_creation, node_t, nodes)
 	BOOST_CHECK_EQUAL(line_count, 10 + 8 + 2);
 }
 
+BOOST_AUTO_TEST_CASE(test_region_waves)
+{
+	using fc::graph::graph_node_properties;
+	using fc::graph::graph_port_properties;
+	const auto connect = [this](const graph_node_properties& source,
+			const graph_node_properties& sink)
+	{
+		const auto type = graph_port_properties::port_type::EVENT;
+		graph.add_connection(
+				{source, graph_port_properties{"out", source.get_id(), type}},
+				{sink, graph_port_properties{"in", sink.get_id(), type}});
+	};
+	const auto fast = fc::thread::cycle_control::fast_tick;
+	fc::parallel_region a{"a", fast};
+	fc::parallel_region b{"b", fast};
+	fc::parallel_region c{"c", fast};
+	fc::parallel_region slow{"slow", fc::thread::cycle_control::medium_tick};
+	fc::parallel_region x{"x", fast};
+	fc::parallel_region y{"y", fast};
+	fc::parallel_region after_cycle{"after_cycle", fast};
+
+	const graph_node_properties node_a{"a", &a};
+	const graph_node_properties node_b{"b", &b};
+	const graph_node_properties node_c{"c", &c};
+	const graph_node_properties node_slow{"slow", &slow};
+	const graph_node_properties node_x{"x", &x};
+	const graph_node_properties node_y{"y", &y};
+	const graph_node_properties node_after_cycle{"after_cycle", &after_cycle};
+	const graph_node_properties pure{"pure", nullptr, true};
+
+	connect(node_a, node_b);
+	connect(node_a, node_c);
+	// dependencies through nodes without region count as well
+	connect(node_b, pure);
+	connect(pure, node_c);
+	// regions with different tick rates are not ordered
+	connect(node_a, node_slow);
+	// cycles can't be ordered
+	connect(node_c, node_x);
+	connect(node_x, node_y);
+	connect(node_y, node_x);
+	connect(node_y, node_after_cycle);
+
+	const auto waves = fc::graph::region_waves(graph);
+	BOOST_CHECK_EQUAL(waves.at(&a), 0);
+	BOOST_CHECK_EQUAL(waves.at(&b), 1);
+	BOOST_CHECK_EQUAL(waves.at(&c), 2);
+	BOOST_CHECK_EQUAL(waves.at(&slow), 0);
+	BOOST_CHECK_EQUAL(waves.at(&x), fc::parallel_region::unordered);
+	BOOST_CHECK_EQUAL(waves.at(&y), fc::parallel_region::unordered);
+	BOOST_CHECK_EQUAL(waves.at(&after_cycle), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -2,9 +2,15 @@
 
 #include "extended/base_node.hpp"
 #include "infrastructure.hpp"
+#include "scheduler/clock.hpp"
 
 // std
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
 
 BOOST_AUTO_TEST_SUITE( test_infrastructure )
 
@@ -16,6 +22,41 @@ struct null : fc::tree_base_node
 	explicit null(const fc::node_args& node)
 	: tree_base_node(node) {}
 };
+
+using fc::operator>>;
+using time_point = fc::virtual_clock::steady::time_point;
+
+/// sends the virtual time of every cycle of its region
+struct clock_source : fc::tree_base_node
+{
+	static constexpr auto default_name = "clock_source";
+	explicit clock_source(const fc::node_args& node)
+		: tree_base_node(node), out(this)
+	{
+		region()->work_tick() >> [this] { out.fire(fc::virtual_clock::steady::now()); };
+	}
+	event_source<time_point> out;
+};
+
+/// counts if times are received in the cycle they were sent in or later
+struct clock_sink : fc::tree_base_node
+{
+	static constexpr auto default_name = "clock_sink";
+	explicit clock_sink(const fc::node_args& node)
+		: tree_base_node(node)
+		, in(this, [this](time_point sent)
+			{
+				if (sent == fc::virtual_clock::steady::now())
+					++same_cycle;
+				else
+					++later;
+			})
+	{
+	}
+	event_sink<time_point> in;
+	std::atomic<int> same_cycle{0};
+	std::atomic<int> later{0};
+};
 }
 
 /*
@@ -34,4 +75,196 @@ BOOST_AUTO_TEST_CASE(test_buildup)
 	BOOST_CHECK_EQUAL(test_node.name(), "null");
 }
 
+BOOST_AUTO_TEST_CASE(test_arbitrary_region_rates)
+{
+	using namespace std::chrono_literals;
+	fc::infrastructure test_is;
+
+	BOOST_CHECK(test_is.add_region("20ms", 20ms) != nullptr);
+	BOOST_CHECK(test_is.add_region("250ms", 250ms) != nullptr);
+	BOOST_CHECK_THROW(test_is.add_region("invalid", 15ms), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_sub_millisecond_base_tick)
+{
+	using namespace std::chrono_literals;
+	fc::infrastructure test_is{100us};
+
+	BOOST_CHECK(test_is.add_region("1kHz", 1ms) != nullptr);
+	BOOST_CHECK(test_is.add_region("10kHz", 100us) != nullptr);
+	BOOST_CHECK_THROW(test_is.add_region("invalid", 150us), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_region_bound_to_worker_group)
+{
+	using namespace std::chrono_literals;
+	fc::thread::scheduler_config config;
+	config.workers = {{{}, 0}, {{}, 1}};
+	fc::infrastructure test_is{config, 1ms};
+
+	BOOST_CHECK_THROW(test_is.add_region("invalid", 1ms, 2), std::invalid_argument);
+	auto region = test_is.add_region("bound", 1ms, 1);
+	auto child = region->new_region("child", 1ms);
+
+	std::mutex ids_mutex;
+	std::set<std::thread::id> region_threads;
+	std::set<std::thread::id> child_threads;
+	std::atomic<int> ticks{0};
+	using fc::operator>>;
+	region->work_tick() >> [&]
+	{
+		std::lock_guard<std::mutex> lock(ids_mutex);
+		region_threads.insert(std::this_thread::get_id());
+		++ticks;
+	};
+	child->work_tick() >> [&]
+	{
+		std::lock_guard<std::mutex> lock(ids_mutex);
+		child_threads.insert(std::this_thread::get_id());
+	};
+
+	test_is.start_scheduler();
+	while (ticks < 20)
+		std::this_thread::sleep_for(1ms);
+	test_is.stop_scheduler();
+
+	// both regions are executed by the single worker of group 1
+	BOOST_CHECK_EQUAL(region_threads.size(), 1);
+	BOOST_CHECK(child_threads == region_threads);
+}
+
+BOOST_AUTO_TEST_CASE(test_dependency_order)
+{
+	fc::infrastructure test_is;
+	test_is.order_regions_by_dependencies();
+	const auto tick = fc::thread::cycle_control::fast_tick;
+
+	auto producer = test_is.add_region("producer", tick);
+	auto consumer = test_is.add_region("consumer", tick);
+	auto& source = test_is.node_owner().make_child<clock_source>(producer);
+	auto& sink = test_is.node_owner().make_child<clock_sink>(consumer);
+	source.out >> sink.in;
+
+	// regions in a cycle can't be ordered and are double buffered.
+	auto cycle_a = test_is.add_region("cycle_a", tick);
+	auto cycle_b = test_is.add_region("cycle_b", tick);
+	auto& source_a = test_is.node_owner().make_child<clock_source>(cycle_a);
+	auto& sink_a = test_is.node_owner().make_child<clock_sink>(cycle_a);
+	auto& source_b = test_is.node_owner().make_child<clock_source>(cycle_b);
+	auto& sink_b = test_is.node_owner().make_child<clock_sink>(cycle_b);
+	source_a.out >> sink_b.in;
+	source_b.out >> sink_a.in;
+
+	test_is.start_scheduler();
+	while (sink.same_cycle + sink.later < 10 || sink_b.later < 10)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	test_is.stop_scheduler();
+
+	BOOST_CHECK_GE(sink.same_cycle, 10);
+	BOOST_CHECK_EQUAL(sink.later, 0);
+	BOOST_CHECK_EQUAL(sink_b.same_cycle, 0);
+	BOOST_CHECK_EQUAL(sink_a.same_cycle, 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_fused_regions_keep_buffering)
+{
+	using namespace std::chrono_literals;
+	fc::infrastructure test_is;
+	test_is.fuse_regions(1ms);
+	const auto tick = fc::thread::cycle_control::fast_tick;
+
+	auto producer = test_is.add_region("producer", tick);
+	auto consumer = test_is.add_region("consumer", tick);
+	producer->declare_cost(10us);
+	consumer->declare_cost(10us);
+	auto& source = test_is.node_owner().make_child<clock_source>(producer);
+	auto& sink = test_is.node_owner().make_child<clock_sink>(consumer);
+	source.out >> sink.in;
+
+	test_is.start_scheduler();
+	while (sink.later < 10)
+		std::this_thread::sleep_for(1ms);
+	test_is.stop_scheduler();
+
+	// data between fused regions still arrives in the next cycle
+	BOOST_CHECK_EQUAL(sink.same_cycle, 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_event_triggered_region)
+{
+	using namespace std::chrono_literals;
+	fc::infrastructure test_is{1ms};
+	const auto tick = 10ms;
+
+	auto producer = test_is.add_region("producer", tick);
+	auto consumer = test_is.add_triggered_region("consumer", 1ms);
+	BOOST_CHECK(consumer->is_event_triggered());
+	auto& source = test_is.node_owner().make_child<clock_source>(producer);
+	auto& sink = test_is.node_owner().make_child<clock_sink>(consumer);
+	source.out >> sink.in;
+	std::atomic<int> consumer_runs{0};
+	consumer->work_tick() >> [&consumer_runs] { ++consumer_runs; };
+
+	test_is.start_scheduler();
+	while (sink.same_cycle + sink.later < 10)
+		std::this_thread::sleep_for(1ms);
+	test_is.stop_scheduler();
+
+	// the consumer only runs when data arrives, which is far less often than its minimum interval.
+	const int received = sink.same_cycle + sink.later;
+	BOOST_CHECK_GE(consumer_runs, 10);
+	BOOST_CHECK_LE(consumer_runs, 2 * received);
+	// and it usually receives the events within the cycle of the producer
+	BOOST_CHECK_GT(sink.same_cycle, sink.later);
+}
+
+BOOST_AUTO_TEST_CASE(test_run_until)
+{
+	using namespace std::chrono_literals;
+	fc::infrastructure test_is;
+	test_is.use_own_clock();
+	auto region = test_is.add_region("region", fc::thread::cycle_control::fast_tick);
+	int ticks{0};
+	region->work_tick() >> [&ticks] { ++ticks; };
+
+	// cycles are executed until the condition holds, independent of the wall clock
+	test_is.run_until([&ticks] { return ticks == 5; });
+	BOOST_CHECK_EQUAL(ticks, 5);
+
+	fc::virtual_clock::context::scope in_context{test_is.clock_context()};
+	const auto begin = fc::wall_clock::steady::now();
+	test_is.run_until(fc::virtual_clock::steady::now() + 10s);
+	BOOST_CHECK_EQUAL(ticks, 5 + 1000);
+	BOOST_CHECK(fc::wall_clock::steady::now() - begin < 10s);
+}
+
+BOOST_AUTO_TEST_CASE(test_iterate_main_loop_wakes_on_failure)
+{
+	using namespace std::chrono_literals;
+	fc::infrastructure test_is;
+	// without a running scheduler there is nothing to supervise
+	BOOST_CHECK(!test_is.iterate_main_loop(10s));
+	BOOST_CHECK_THROW(test_is.infinite_main_loop(), std::logic_error);
+
+	auto region = test_is.add_region("stuck", fc::thread::cycle_control::fast_tick);
+	std::atomic<bool> stuck{true};
+	region->work_tick() >> [&stuck]
+	{
+		while (stuck)
+			std::this_thread::sleep_for(1ms);
+	};
+
+	test_is.start_scheduler();
+	const auto begin = fc::wall_clock::steady::now();
+	BOOST_CHECK_THROW(test_is.iterate_main_loop(10s), fc::out_of_time_exception);
+	BOOST_CHECK(fc::wall_clock::steady::now() - begin < 5s);
+	stuck = false;
+	test_is.stop_scheduler();
+
+	// a stopped scheduler does not block
+	BOOST_CHECK(!test_is.iterate_main_loop(10s));
+	test_is.infinite_main_loop();
+	BOOST_CHECK(fc::wall_clock::steady::now() - begin < 5s);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
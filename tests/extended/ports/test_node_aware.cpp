@@ -10,6 +10,11 @@
 #include <boost/mpl/list.hpp>
 #include <boost/variant.hpp>
 
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
 namespace
 {
 template<class base>
@@ -374,4 +379,173 @@ BOOST_AUTO_TEST_CASE(test_state_same_region)
 	BOOST_CHECK_EQUAL(sink.get(), 1);
 }
 
+BOOST_AUTO_TEST_CASE(test_event_ring)
+{
+	parallel_region region_1{"r1", fc::thread::cycle_control::fast_tick};
+	parallel_region region_2{"r2", fc::thread::cycle_control::slow_tick};
+	parallel_region region_3{"r3", fc::thread::cycle_control::slow_tick};
+	region_1.send_events_through_ring(region_2, event_ring_config{2});
+
+	std::vector<int> received_2;
+	std::vector<int> received_3;
+	int_event_source source{region_1};
+	node_aware<pure::event_sink<int>> sink_2{region_2, [&](int i) { received_2.push_back(i); }};
+	node_aware<pure::event_sink<int>> sink_3{region_3, [&](int i) { received_3.push_back(i); }};
+	source >> sink_2;
+	source >> sink_3;
+
+	for (int i = 0; i != 3; ++i)
+		source.fire(i);
+	// the ring sends on the next work tick without switch ticks, but drops the third event
+	region_2.ticks.in_work()();
+	region_3.ticks.in_work()();
+	BOOST_CHECK((received_2 == std::vector<int>{0, 1}));
+	BOOST_CHECK(received_3.empty());
+
+	// the setting of the port overrides the regions
+	int_event_source ring_source{region_1};
+	ring_source.send_events_through_ring(event_ring_config{8});
+	ring_source >> sink_3;
+	ring_source.fire(3);
+	region_3.ticks.in_work()();
+	BOOST_CHECK((received_3 == std::vector<int>{3}));
+}
+
+BOOST_AUTO_TEST_CASE(test_shared_fan_out_buffer)
+{
+	parallel_region region_1{"r1", fc::thread::cycle_control::fast_tick};
+	parallel_region region_2{"r2", fc::thread::cycle_control::slow_tick};
+	parallel_region region_3{"r3", fc::thread::cycle_control::slow_tick};
+
+	std::vector<std::pair<int, int>> received;
+	const auto record = [&received](int sink) { return [&received, sink](int i)
+	{
+		received.emplace_back(sink, i);
+	}; };
+	int_event_source source{region_1};
+	node_aware<pure::event_sink<int>> sink_1{region_2, record(1)};
+	node_aware<pure::event_sink<int>> sink_2{region_2, record(2)};
+	node_aware<pure::event_sink<int>> sink_3{region_2, record(3)};
+	node_aware<pure::event_sink<int>> sink_4{region_3, record(4)};
+	source >> sink_1;
+	source >> [](int i) { return i * 10; } >> sink_2;
+	source >> sink_3;
+	source >> sink_4;
+	// a single buffer per region
+	BOOST_CHECK_EQUAL(source.nr_connected_handlers(), 2);
+
+	for (int i = 1; i != 4; ++i)
+		source.fire(i);
+	region_1.ticks.switch_buffers();
+	region_2.ticks.switch_buffers();
+	region_2.ticks.in_work()();
+	// events arrive in the order they were fired, each at all sinks in the order of connection
+	const std::vector<std::pair<int, int>> expected{
+			{1, 1}, {2, 10}, {3, 1}, {1, 2}, {2, 20}, {3, 2}, {1, 3}, {2, 30}, {3, 3}};
+	BOOST_CHECK(received == expected);
+
+	region_3.ticks.switch_buffers();
+	region_3.ticks.in_work()();
+	BOOST_CHECK_EQUAL(received.size(), 12);
+	BOOST_CHECK((received.back() == std::pair<int, int>{4, 3}));
+
+	// sinks connected later receive the events of the following cycles
+	received.clear();
+	node_aware<pure::event_sink<int>> sink_5{region_2, record(5)};
+	source >> sink_5;
+	source.fire(4);
+	region_1.ticks.switch_buffers();
+	region_2.ticks.switch_buffers();
+	region_2.ticks.in_work()();
+	BOOST_CHECK((received == std::vector<std::pair<int, int>>{{1, 4}, {2, 40}, {3, 4}, {5, 4}}));
+}
+
+BOOST_AUTO_TEST_CASE(test_shared_buffer_per_region_instance)
+{
+	parallel_region region_1{"r1", fc::thread::cycle_control::fast_tick};
+	parallel_region region_2{"r2", fc::thread::cycle_control::slow_tick};
+	parallel_region namesake{"r2", fc::thread::cycle_control::slow_tick};
+
+	std::vector<int> received;
+	std::vector<int> received_namesake;
+	int_event_source source{region_1};
+	node_aware<pure::event_sink<int>> sink_1{region_2, [&received](int i) { received.push_back(i); }};
+	node_aware<pure::event_sink<int>> sink_2{region_2, [&received](int i) { received.push_back(i); }};
+	node_aware<pure::event_sink<int>> sink_3{namesake,
+			[&received_namesake](int i) { received_namesake.push_back(i); }};
+	const auto connection_1 = source.connect(sink_1);
+	const auto connection_2 = source.connect(sink_2);
+	const auto connection_3 = source.connect(sink_3);
+	// every connection co-owns the buffer, not only the first one to the region
+	BOOST_CHECK(connection_2.get_buffer() == connection_1.get_buffer());
+	// regions with equal ids are still distinct regions with buffers of their own
+	BOOST_CHECK(connection_3.get_buffer() != connection_1.get_buffer());
+	BOOST_CHECK_EQUAL(source.nr_connected_handlers(), 2);
+
+	source.fire(1);
+	region_1.ticks.switch_buffers();
+	region_2.ticks.switch_buffers();
+	region_2.ticks.in_work()();
+	BOOST_CHECK((received == std::vector<int>{1, 1}));
+	BOOST_CHECK(received_namesake.empty());
+
+	namesake.ticks.switch_buffers();
+	namesake.ticks.in_work()();
+	BOOST_CHECK((received_namesake == std::vector<int>{1}));
+}
+
+BOOST_AUTO_TEST_CASE(test_shared_state_buffer)
+{
+	parallel_region region_1{"r1", fc::thread::cycle_control::fast_tick};
+	parallel_region region_2{"r2", fc::thread::cycle_control::fast_tick};
+
+	int pulls = 0;
+	node_aware<pure::state_source<int>> source{region_1, [&pulls] { return ++pulls; }};
+	node_aware<pure::state_sink<int>> sink_1{region_2};
+	node_aware<pure::state_sink<int>> sink_2{region_2};
+	source >> sink_1;
+	source >> sink_2;
+
+	region_1.ticks.in_work()();
+	region_2.ticks.switch_buffers();
+	// the state is pulled once for both sinks
+	BOOST_CHECK_EQUAL(pulls, 1);
+	BOOST_CHECK_EQUAL(sink_1.get(), 1);
+	BOOST_CHECK_EQUAL(sink_2.get(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_keep_latest_events)
+{
+	parallel_region region_1{"r1", fc::thread::cycle_control::fast_tick};
+	parallel_region region_2{"r2", fc::thread::cycle_control::slow_tick};
+
+	std::vector<int> per_key;
+	std::vector<int> latest;
+	int_event_source keyed_source{region_1};
+	int_event_source source{region_1};
+	keyed_source.keep_latest_event_per_key([](int i) { return i % 3; });
+	source.keep_latest_event();
+	node_aware<pure::event_sink<int>> keyed_sink{region_2, [&](int i) { per_key.push_back(i); }};
+	node_aware<pure::event_sink<int>> sink{region_2, [&](int i) { latest.push_back(i); }};
+	keyed_source >> keyed_sink;
+	source >> sink;
+
+	for (int i = 0; i != 10; ++i)
+	{
+		keyed_source.fire(i);
+		source.fire(i);
+	}
+	region_1.ticks.switch_buffers();
+	region_2.ticks.switch_buffers();
+	region_2.ticks.in_work()();
+	BOOST_CHECK((per_key == std::vector<int>{9, 7, 8}));
+	BOOST_CHECK((latest == std::vector<int>{9}));
+
+	// triggered regions are woken by inboxes, which keep all events
+	parallel_region triggered{"triggered", fc::thread::cycle_control::fast_tick};
+	triggered.trigger_on_events(std::chrono::milliseconds(1));
+	node_aware<pure::event_sink<int>> triggered_sink{triggered, [](int) {}};
+	BOOST_CHECK_THROW(source >> triggered_sink, std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1,16 +1,28 @@
 // boost
+#include <boost/mpl/list.hpp>
 #include <boost/test/unit_test.hpp>
 
 #include "extended/ports/connection_buffer.hpp"
 #include "pure/pure_ports.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 BOOST_AUTO_TEST_SUITE(test_eventbuffer)
 
 using fc::operator>>;
 
-BOOST_AUTO_TEST_CASE( test_state_buffer )
+using state_buffers = boost::mpl::list<fc::state_buffer<int>, fc::triple_state_buffer<int>>;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(test_state_buffer, buffer_t, state_buffers)
 {
-	fc::state_buffer<int> test_buffer{};
+	buffer_t test_buffer{};
 	int test_state{1};
 	fc::pure::state_source<int> source([&test_state](){ return test_state; });
 	fc::pure::state_sink<int> sink{};
@@ -84,4 +96,367 @@ BOOST_AUTO_TEST_CASE(test_event_buffer)
 	}
 }
 
+BOOST_AUTO_TEST_CASE(test_handoff)
+{
+	fc::event_buffer<int> events{};
+	fc::state_buffer<int> states{};
+	bool hand_off = true;
+	events.hand_off_if([&hand_off] { return hand_off; });
+	states.hand_off_if([&hand_off] { return hand_off; });
+
+	int received{0};
+	fc::pure::event_source<int> event_source{};
+	fc::pure::event_sink<int> event_sink([&](int i) { received = i; });
+	event_source >> events.in();
+	events.out() >> event_sink;
+
+	int state{1};
+	fc::pure::state_source<int> state_source([&state]() { return state; });
+	fc::pure::state_sink<int> state_sink{};
+	state_source >> states.in();
+	states.out() >> state_sink;
+
+	// while handing off, the regular switch has no effect
+	event_source.fire(1);
+	events.switch_active_passive_tick()();
+	events.work_tick()();
+	BOOST_CHECK_EQUAL(received, 0);
+	states.work_tick()();
+	states.switch_active_passive_tick()();
+	BOOST_CHECK_EQUAL(state_sink.get(), 0);
+
+	// but the handoff makes the data available at once
+	events.handoff_tick()();
+	events.work_tick()();
+	BOOST_CHECK_EQUAL(received, 1);
+	states.handoff_tick()();
+	BOOST_CHECK_EQUAL(state_sink.get(), 1);
+
+	// without handoff, buffers switch as before
+	hand_off = false;
+	state = 2;
+	event_source.fire(2);
+	events.handoff_tick()();
+	states.handoff_tick()();
+	events.work_tick()();
+	BOOST_CHECK_EQUAL(received, 1);
+	BOOST_CHECK_EQUAL(state_sink.get(), 1);
+	events.switch_active_passive_tick()();
+	events.work_tick()();
+	BOOST_CHECK_EQUAL(received, 2);
+	states.work_tick()();
+	states.switch_active_passive_tick()();
+	BOOST_CHECK_EQUAL(state_sink.get(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_inbox)
+{
+	fc::event_inbox<int> events{};
+	fc::state_inbox<int> states{};
+	int published{0};
+	events.on_publish([&published] { ++published; });
+
+	std::vector<int> received;
+	fc::pure::event_source<int> event_source{};
+	fc::pure::event_sink<int> event_sink([&](int i) { received.push_back(i); });
+	event_source >> events.in();
+	events.out() >> event_sink;
+
+	int state{1};
+	fc::pure::state_source<int> state_source([&state]() { return state; });
+	fc::pure::state_sink<int> state_sink{};
+	state_source >> states.in();
+	states.out() >> state_sink;
+
+	// nothing is published before the producer is done
+	event_source.fire(1);
+	events.collect_tick()();
+	events.work_tick()();
+	BOOST_CHECK(received.empty());
+	states.collect_tick()();
+	BOOST_CHECK_EQUAL(state_sink.get(), 0);
+
+	// publishing without events does not notify the consumer
+	events.publish_tick()();
+	events.publish_tick()();
+	BOOST_CHECK_EQUAL(published, 1);
+	states.publish_tick()();
+	BOOST_CHECK_EQUAL(state_sink.get(), 0);
+
+	// events of several publications are collected at once and in order
+	event_source.fire(2);
+	events.publish_tick()();
+	BOOST_CHECK_EQUAL(published, 2);
+	events.collect_tick()();
+	events.work_tick()();
+	BOOST_CHECK((received == std::vector<int>{1, 2}));
+	states.collect_tick()();
+	BOOST_CHECK_EQUAL(state_sink.get(), 1);
+
+	// the consumer keeps the last state until a new one is published
+	state = 2;
+	states.collect_tick()();
+	BOOST_CHECK_EQUAL(state_sink.get(), 1);
+	states.publish_tick()();
+	states.collect_tick()();
+	BOOST_CHECK_EQUAL(state_sink.get(), 2);
+}
+
+namespace
+{
+/// counts how often it is copied
+struct copy_counter
+{
+	copy_counter() = default;
+	copy_counter(const copy_counter& other) : value(other.value) { ++copies; }
+	copy_counter(copy_counter&&) = default;
+	copy_counter& operator=(const copy_counter& other)
+	{
+		value = other.value;
+		++copies;
+		return *this;
+	}
+	copy_counter& operator=(copy_counter&&) = default;
+
+	int value = 0;
+	static int copies;
+};
+int copy_counter::copies = 0;
+}
+
+BOOST_AUTO_TEST_CASE(test_triple_state_buffer_swaps)
+{
+	static_assert(std::is_same<fc::detail::buffer<int, fc::state_tag>::type,
+			fc::state_buffer<int>>{}, "small states are copied");
+	static_assert(std::is_same<fc::detail::buffer<std::array<double, 1024>, fc::state_tag>::type,
+			fc::triple_state_buffer<std::array<double, 1024>>>{}, "large states are swapped");
+	static_assert(std::is_same<fc::detail::buffer<std::string, fc::state_tag>::type,
+			fc::triple_state_buffer<std::string>>{}, "expensive copies are avoided");
+
+	fc::triple_state_buffer<copy_counter> test_buffer{};
+	int produced{0};
+	fc::pure::state_source<copy_counter> source([&produced]()
+	{
+		copy_counter state;
+		state.value = ++produced;
+		return state;
+	});
+	source >> test_buffer.in();
+
+	copy_counter::copies = 0;
+	for (int i = 0; i != 10; ++i)
+	{
+		test_buffer.work_tick()();
+		test_buffer.switch_passive_tick()();
+		test_buffer.switch_active_tick()();
+		test_buffer.work_tick()();
+		test_buffer.switch_active_passive_tick()();
+	}
+	// switching never copies, only reading the buffer does
+	BOOST_CHECK_EQUAL(copy_counter::copies, 0);
+	BOOST_CHECK_EQUAL(test_buffer.out()().value, produced);
+	BOOST_CHECK_EQUAL(copy_counter::copies, 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_event_buffer_moves_events)
+{
+	fc::event_buffer<copy_counter> test_buffer{};
+	fc::pure::event_source<copy_counter> source{};
+	std::vector<int> received;
+	std::vector<int> batched;
+	fc::pure::event_sink<copy_counter> sink([&](copy_counter c) { received.push_back(c.value); });
+	fc::pure::event_sink<fc::event_batch<copy_counter>> batch_sink(
+			[&](fc::event_batch<copy_counter> events)
+			{
+				for (const auto& c : events)
+					batched.push_back(c.value);
+			});
+	source >> test_buffer.in();
+	test_buffer.out() >> sink;
+	test_buffer.batch_out() >> batch_sink;
+
+	copy_counter::copies = 0;
+	for (int i = 0; i != 3; ++i)
+	{
+		copy_counter c;
+		c.value = i;
+		source.fire(std::move(c));
+	}
+	// through the active and passive switch
+	test_buffer.switch_active_tick()();
+	test_buffer.switch_passive_tick()();
+	test_buffer.work_tick()();
+	// and appended to events which have not been sent yet
+	for (int i = 3; i != 6; ++i)
+	{
+		copy_counter c;
+		c.value = i;
+		source.fire(std::move(c));
+		test_buffer.switch_active_passive_tick()();
+	}
+	test_buffer.work_tick()();
+	BOOST_CHECK_EQUAL(copy_counter::copies, 0);
+
+	const std::vector<int> expected{0, 1, 2, 3, 4, 5};
+	BOOST_CHECK(received == expected);
+	// batches arrive once per work tick and before the single events
+	BOOST_CHECK(batched == expected);
+
+	// no batch without events
+	test_buffer.work_tick()();
+	BOOST_CHECK(batched == expected);
+}
+
+BOOST_AUTO_TEST_CASE(test_ring_event_buffer)
+{
+	fc::ring_event_buffer<copy_counter> test_buffer{fc::event_ring_config{4}};
+	fc::pure::event_source<copy_counter> source{};
+	std::vector<int> received;
+	fc::pure::event_sink<copy_counter> sink([&](copy_counter c) { received.push_back(c.value); });
+	source >> test_buffer.in();
+	test_buffer.out() >> sink;
+	BOOST_CHECK_EQUAL(test_buffer.capacity(), 4);
+
+	copy_counter::copies = 0;
+	for (int i = 0; i != 3; ++i)
+	{
+		copy_counter c;
+		c.value = i;
+		source.fire(std::move(c));
+	}
+	BOOST_CHECK(received.empty());
+	// no switch tick, events are sent on the next work tick
+	test_buffer.work_tick()();
+	BOOST_CHECK_EQUAL(copy_counter::copies, 0);
+	BOOST_CHECK((received == std::vector<int>{0, 1, 2}));
+
+	// wrapping around the end of the ring keeps the order
+	for (int i = 3; i != 7; ++i)
+	{
+		copy_counter c;
+		c.value = i;
+		source.fire(std::move(c));
+	}
+	test_buffer.work_tick()();
+	BOOST_CHECK((received == std::vector<int>{0, 1, 2, 3, 4, 5, 6}));
+	BOOST_CHECK_EQUAL(test_buffer.dropped(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_ring_overflow)
+{
+	using fc::ring_overflow;
+	const auto overflowed = [](ring_overflow overflow)
+	{
+		fc::ring_event_buffer<int> test_buffer{fc::event_ring_config{2, overflow}};
+		fc::pure::event_source<int> source{};
+		std::vector<int> received;
+		std::vector<size_t> reports;
+		fc::pure::event_sink<int> sink([&](int i) { received.push_back(i); });
+		fc::pure::event_sink<size_t> report_sink([&](size_t lost) { reports.push_back(lost); });
+		source >> test_buffer.in();
+		test_buffer.out() >> sink;
+		test_buffer.overflows() >> report_sink;
+
+		for (int i = 0; i != 5; ++i)
+			source.fire(i);
+		BOOST_CHECK_EQUAL(test_buffer.dropped(), 3);
+		test_buffer.work_tick()();
+		// nothing is lost in a cycle without overflow
+		source.fire(5);
+		test_buffer.work_tick()();
+		received.insert(end(received), begin(reports), end(reports));
+		return received;
+	};
+
+	BOOST_CHECK((overflowed(ring_overflow::drop_oldest) == std::vector<int>{3, 4, 5}));
+	BOOST_CHECK((overflowed(ring_overflow::drop_newest) == std::vector<int>{0, 1, 5}));
+	// the lost events are reported once
+	BOOST_CHECK((overflowed(ring_overflow::report) == std::vector<int>{0, 1, 5, 3}));
+}
+
+BOOST_AUTO_TEST_CASE(test_void_ring_event_buffer)
+{
+	fc::ring_event_buffer<void> test_buffer{fc::event_ring_config{2, fc::ring_overflow::report}};
+	fc::pure::event_source<void> source{};
+	int received = 0;
+	size_t lost = 0;
+	fc::pure::event_sink<void> sink([&received] { ++received; });
+	fc::pure::event_sink<size_t> report_sink([&lost](size_t l) { lost += l; });
+	source >> test_buffer.in();
+	test_buffer.out() >> sink;
+	test_buffer.overflows() >> report_sink;
+
+	for (int i = 0; i != 3; ++i)
+		source.fire();
+	test_buffer.work_tick()();
+	BOOST_CHECK_EQUAL(received, 2);
+	BOOST_CHECK_EQUAL(lost, 1);
+	BOOST_CHECK_EQUAL(test_buffer.dropped(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_ring_concurrent_producer)
+{
+	constexpr int nr_of_events = 100000;
+	fc::ring_event_buffer<std::string> test_buffer{fc::event_ring_config{64}};
+	fc::pure::event_source<std::string> source{};
+	std::vector<int> received;
+	fc::pure::event_sink<std::string> sink([&](std::string s) { received.push_back(std::stoi(s)); });
+	source >> test_buffer.in();
+	test_buffer.out() >> sink;
+
+	std::atomic<bool> done{false};
+	std::thread producer([&]
+	{
+		for (int i = 0; i != nr_of_events; ++i)
+			source.fire(std::to_string(i));
+		done = true;
+	});
+	while (!done)
+		test_buffer.work_tick()();
+	producer.join();
+	test_buffer.work_tick()();
+
+	// every event arrived in order or was dropped
+	BOOST_CHECK_EQUAL(received.size() + test_buffer.dropped(), nr_of_events);
+	BOOST_CHECK(std::is_sorted(begin(received), end(received)));
+	BOOST_CHECK(std::adjacent_find(begin(received), end(received)) == end(received));
+}
+
+BOOST_AUTO_TEST_CASE(test_coalescing_event_buffer)
+{
+	using telemetry = std::pair<int, std::string>;
+	fc::coalescing_event_buffer<telemetry, int> test_buffer{[](const telemetry& t)
+	{
+		return t.first;
+	}};
+	fc::pure::event_source<telemetry> source{};
+	std::vector<telemetry> received;
+	fc::pure::event_sink<telemetry> sink([&](telemetry t) { received.push_back(t); });
+	source >> test_buffer.in();
+	test_buffer.out() >> sink;
+
+	source.fire(telemetry{2, "a"});
+	source.fire(telemetry{1, "b"});
+	source.fire(telemetry{2, "c"});
+	test_buffer.switch_active_tick()();
+	// events switched but not read yet are replaced by later events with the same key
+	source.fire(telemetry{1, "d"});
+	source.fire(telemetry{3, "e"});
+	test_buffer.switch_active_tick()();
+	BOOST_CHECK(received.empty());
+	test_buffer.switch_passive_tick()();
+	test_buffer.work_tick()();
+	// the latest event of every key, in the order in which the keys arrived first
+	const std::vector<telemetry> expected{{2, "c"}, {1, "d"}, {3, "e"}};
+	BOOST_CHECK(received == expected);
+
+	// only events of the following cycles are sent afterwards
+	received.clear();
+	source.fire(telemetry{3, "f"});
+	source.fire(telemetry{3, "g"});
+	test_buffer.switch_active_passive_tick()();
+	test_buffer.work_tick()();
+	BOOST_CHECK((received == std::vector<telemetry>{{3, "g"}}));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
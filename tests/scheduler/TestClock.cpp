@@ -6,6 +6,8 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <thread>
+
 
 using namespace fc;
 namespace chr = std::chrono;
@@ -89,4 +91,33 @@ BOOST_AUTO_TEST_CASE(test_time_t_conversion)
 			== chr::time_point_cast<chr::seconds>(back_converted));
 }
 
+BOOST_AUTO_TEST_CASE(test_context_scope)
+{
+	const auto default_start = virtual_clock::steady::now();
+	virtual_clock::context simulation;
+	{
+		virtual_clock::context::scope in_simulation{simulation};
+		BOOST_CHECK(&virtual_clock::context::current() == &simulation);
+		BOOST_CHECK(virtual_clock::steady::now().time_since_epoch() == master::duration::zero());
+		master::advance();
+		BOOST_CHECK(virtual_clock::steady::now().time_since_epoch() == one_tick);
+
+		// the clock of other threads is not affected
+		std::thread other{[default_start]
+		{
+			BOOST_CHECK(virtual_clock::steady::now() == default_start);
+		}};
+		other.join();
+
+		// nested scopes restore the previous context
+		{
+			virtual_clock::context::scope in_default{virtual_clock::context::process_default()};
+			BOOST_CHECK(virtual_clock::steady::now() == default_start);
+		}
+		BOOST_CHECK(virtual_clock::steady::now().time_since_epoch() == one_tick);
+	}
+	BOOST_CHECK(&virtual_clock::context::current() == &virtual_clock::context::process_default());
+	BOOST_CHECK(virtual_clock::steady::now() == default_start);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
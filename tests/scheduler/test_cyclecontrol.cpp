@@ -5,16 +5,25 @@
  *      Author: jschwan
  */
 
+#include "extended/ports/connection_buffer.hpp"
 #include "scheduler/cyclecontrol.hpp"
+#include "scheduler/detail/dedicated_worker.hpp"
 #include "scheduler/parallelscheduler.hpp"
+#include "scheduler/serialschedulers.hpp"
 
 #include <boost/test/unit_test.hpp>
 #include <boost/test/floating_point_comparison.hpp>
+#include <boost/mpl/list.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
 #include <ctime>
 #include <future>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
 #include <unistd.h>
 
 using namespace fc;
@@ -61,7 +70,74 @@ BOOST_AUTO_TEST_CASE(test_adding_tasks_to_running_scheduler)
 	controller.start();
 	BOOST_CHECK_THROW(controller.add_task(sched::periodic_task{[]{}}, sched::cycle_control::fast_tick), std::runtime_error);
 	controller.stop();
-	BOOST_CHECK_THROW(controller.add_task(sched::periodic_task{[]{}}, 2 * sched::cycle_control::slow_tick), std::invalid_argument);
+	BOOST_CHECK_THROW(controller.add_task(sched::periodic_task{[]{}}, sched::cycle_control::min_tick_length / 2), std::invalid_argument);
+	BOOST_CHECK_THROW(controller.add_task(sched::periodic_task{[]{}}, virtual_clock::duration::zero()), std::invalid_argument);
+	BOOST_CHECK_NO_THROW(controller.add_task(sched::periodic_task{[]{}}, 2 * sched::cycle_control::slow_tick));
+}
+
+BOOST_AUTO_TEST_CASE(test_arbitrary_tick_rates)
+{
+	namespace sched = fc::thread;
+	using cycle = sched::cycle_control;
+	using namespace std::chrono_literals;
+	sched::cycle_control controller{std::make_unique<sched::parallel_scheduler>(),
+		[](auto& task) { return task.wait_until_done(cycle::slow_tick); },
+		std::make_shared<sched::afap_main_loop>()};
+
+	const std::vector<virtual_clock::duration> rates{20ms, 50ms, 250ms, 30ms, cycle::fast_tick};
+	std::vector<std::atomic<int>> counts(rates.size());
+	for (size_t i = 0; i != rates.size(); ++i)
+		controller.add_task(sched::periodic_task{[&counts, i] { ++counts[i]; }}, rates[i]);
+
+	std::atomic<int> base_count{0};
+	std::atomic_bool finished{false};
+	controller.add_task(sched::periodic_task{[&]
+	{
+		// stop after exactly 1s of virtual time
+		if (++base_count == 100)
+			finished.store(true);
+	}}, cycle::min_tick_length);
+
+	controller.start();
+	while (!finished.load())
+		std::this_thread::yield();
+	controller.stop();
+
+	const int ticks = base_count.load();
+	BOOST_CHECK_GE(ticks, 100);
+	for (size_t i = 0; i != rates.size(); ++i)
+	{
+		const int per_period = rates[i] / cycle::min_tick_length;
+		BOOST_CHECK_GE(counts[i].load(), ticks / per_period);
+		BOOST_CHECK_LE(counts[i].load(), ticks / per_period + 1);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_base_tick)
+{
+	namespace sched = fc::thread;
+	using namespace std::chrono_literals;
+	BOOST_CHECK_THROW(sched::cycle_control(std::make_unique<sched::parallel_scheduler>(),
+			std::make_shared<sched::afap_main_loop>(), 0us), std::invalid_argument);
+
+	sched::cycle_control controller{std::make_unique<sched::parallel_scheduler>(),
+			[](auto& task) { return task.wait_until_done(sched::cycle_control::slow_tick); },
+			std::make_shared<sched::afap_main_loop>(), 100us};
+	BOOST_CHECK(controller.base_tick() == 100us);
+	BOOST_CHECK_THROW(controller.add_task(sched::periodic_task{[]{}}, 150us), std::invalid_argument);
+
+	std::atomic<int> count_base{0};
+	std::atomic<int> count_300us{0};
+	controller.add_task(sched::periodic_task{[&] { ++count_base; }}, 100us);
+	controller.add_task(sched::periodic_task{[&] { ++count_300us; }}, 300us);
+
+	const auto start = virtual_clock::steady::now();
+	for (int i = 0; i != 30; ++i)
+		controller.work();
+	controller.stop();
+	BOOST_CHECK(virtual_clock::steady::now() - start == 3ms);
+	BOOST_CHECK_EQUAL(count_base.load(), 30);
+	BOOST_CHECK_EQUAL(count_300us.load(), 10);
 }
 
 BOOST_AUTO_TEST_CASE(test_fast_main_loop)
@@ -76,31 +152,767 @@ BOOST_AUTO_TEST_CASE(test_fast_main_loop)
 			return res;
 		}, //we don't react to timeouts here, just continue working
 		std::make_shared<sched::afap_main_loop>()};
-	auto count_fast = 0ull;
-	auto count_medium = 0ull;
-	auto count_slow = 0ull;
-	std::atomic_bool slow_done{false};
-	controller.add_task(sched::periodic_task{[&] { ++count_fast; }}, cycle::fast_tick);
-	controller.add_task(sched::periodic_task{[&] { ++count_medium; }}, cycle::medium_tick);
-	controller.add_task(sched::periodic_task{[&, b=false]() mutable {
-		++count_slow;
-		if (!b) {
-			slow_done.store(true);
-			b = true;
-		}
-	}}, cycle::slow_tick);
+
+	// The afap loop keeps advancing the virtual clock while slower tasks run,
+	// but a task is always done before it is due again. Thus the tick at which a run
+	// has been dispatched is the multiple of its period just before the time it sees.
+	std::mutex ticks_mutex;
+	std::vector<virtual_clock::steady::time_point> fast_ticks;
+	std::vector<virtual_clock::steady::time_point> medium_ticks;
+	std::vector<virtual_clock::steady::time_point> slow_ticks;
+	const auto record = [&ticks_mutex](auto& ticks, virtual_clock::steady::duration period)
+	{
+		return [&ticks, &ticks_mutex, period]
+		{
+			const auto since_epoch =
+					virtual_clock::steady::now().time_since_epoch() - cycle::fast_tick;
+			const auto dispatched = virtual_clock::steady::time_point{
+					since_epoch - since_epoch % period};
+			std::lock_guard<std::mutex> lock(ticks_mutex);
+			ticks.push_back(dispatched);
+		};
+	};
+	controller.add_task(sched::periodic_task{record(fast_ticks, cycle::fast_tick)},
+			cycle::fast_tick);
+	controller.add_task(sched::periodic_task{record(medium_ticks, cycle::medium_tick)},
+			cycle::medium_tick);
+	controller.add_task(sched::periodic_task{record(slow_ticks, cycle::slow_tick)},
+			cycle::slow_tick);
+
+	// once the slow task runs the second time, all runs of its first period are done.
+	const auto slow_runs = [&]
+	{
+		std::lock_guard<std::mutex> lock(ticks_mutex);
+		return slow_ticks.size();
+	};
 	controller.start();
-	while (!slow_done.load())
+	while (slow_runs() < 2)
 		std::this_thread::yield();
 	controller.stop();
-	auto ratio_fast_medium = static_cast<double>(count_fast) / count_medium;
-	auto ratio_medium_slow = static_cast<double>(count_medium) / count_slow;
-	auto ratio_fast_slow = static_cast<double>(count_fast) / count_slow;
-	BOOST_CHECK_CLOSE_FRACTION(ratio_fast_medium, 10.0, 1);
-	BOOST_CHECK_CLOSE_FRACTION(ratio_medium_slow, 10.0, 1);
-	BOOST_CHECK_CLOSE_FRACTION(ratio_fast_slow, 100.0, 1);
+
+	std::lock_guard<std::mutex> lock(ticks_mutex);
+	const auto first_slow = slow_ticks.front();
+	const auto in_first_slow_period = [first_slow](const auto& ticks)
+	{
+		return std::count_if(begin(ticks), end(ticks), [first_slow](auto tick)
+		{
+			return tick >= first_slow && tick < first_slow + cycle::slow_tick;
+		});
+	};
+	const auto count_fast = in_first_slow_period(fast_ticks);
+	const auto count_medium = in_first_slow_period(medium_ticks);
+	BOOST_CHECK(slow_ticks[1] - first_slow == cycle::slow_tick);
+	BOOST_CHECK_EQUAL(count_fast, 100);
+	BOOST_CHECK_EQUAL(count_medium, 10);
 	BOOST_TEST_MESSAGE("Fast count: " << count_fast);
 	BOOST_TEST_MESSAGE("Medium count: " << count_medium);
-	BOOST_TEST_MESSAGE("Slow count: " << count_slow);
 }
+BOOST_AUTO_TEST_CASE(test_periodic_task_states)
+{
+	using thread::periodic_task;
+	std::promise<void> release;
+	auto released = release.get_future().share();
+	std::atomic<bool> started{false};
+	periodic_task task{[&]{ started = true; released.wait(); }};
+	BOOST_CHECK(task.current_state() == periodic_task::state::idle);
+	BOOST_CHECK(task.done());
+
+	task.set_work_to_do(true);
+	BOOST_CHECK(task.current_state() == periodic_task::state::scheduled);
+	BOOST_CHECK(!task.done());
+
+	std::thread worker{[&task]{ task(); }};
+	while (!started)
+		std::this_thread::yield();
+	BOOST_CHECK(task.current_state() == periodic_task::state::running);
+	BOOST_CHECK(!task.wait_until_done(std::chrono::milliseconds(1)));
+
+	// a waiting thread is woken up as soon as the task is done
+	auto waiter = std::async(std::launch::async,
+			[&task]{ return task.wait_until_done(std::chrono::seconds(10)); });
+	release.set_value();
+	BOOST_CHECK(waiter.get());
+	worker.join();
+	BOOST_CHECK(task.current_state() == periodic_task::state::idle);
+}
+
+BOOST_AUTO_TEST_CASE(test_countdown_latch)
+{
+	thread::detail::countdown_latch latch;
+	const auto now = wall_clock::steady::now();
+	BOOST_CHECK(latch.wait_until(now));
+
+	constexpr int nr_of_threads = 4;
+	latch.add(nr_of_threads);
+	BOOST_CHECK_EQUAL(latch.count(), nr_of_threads);
+	BOOST_CHECK(!latch.wait_until(wall_clock::steady::now() + std::chrono::milliseconds(1)));
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i != nr_of_threads; ++i)
+		threads.emplace_back([&latch]{ latch.count_down(); });
+	BOOST_CHECK(latch.wait_until(wall_clock::steady::now() + std::chrono::seconds(10)));
+	BOOST_CHECK_EQUAL(latch.count(), 0);
+	for (auto& t : threads)
+		t.join();
+}
+
+namespace
+{
+using time_list = std::vector<virtual_clock::steady::duration>;
+
+/**
+ * runs tasks with the given rates with loop for run_time and returns the virtual times
+ * relative to the start, at which each task ran.
+ */
+std::vector<time_list> task_times(const std::shared_ptr<thread::main_loop>& loop,
+		const time_list& rates, virtual_clock::steady::duration run_time)
+{
+	namespace sched = fc::thread;
+	// the blocking scheduler runs tasks right away, thus they see the exact time of their cycle.
+	sched::cycle_control controller{std::make_unique<sched::blocking_scheduler>(),
+			[](auto&) { return true; }, loop};
+	const auto start = virtual_clock::steady::now();
+	std::vector<time_list> times(rates.size());
+	for (size_t i = 0; i != rates.size(); ++i)
+	{
+		controller.add_task(sched::periodic_task{[&times, i, start]
+		{
+			times[i].push_back(virtual_clock::steady::now() - start);
+		}}, rates[i]);
+	}
+
+	size_t iterations = 0;
+	while (virtual_clock::steady::now() - start < run_time)
+	{
+		loop->loop_body([&controller] { controller.work(); });
+		++iterations;
+	}
+	BOOST_TEST_MESSAGE("iterations: " << iterations);
+
+	// the virtual clock is shared, so the first cycle is not aligned to the task rates.
+	// check against the times at which every task is due, starting from the first tick.
+	const auto base = controller.base_tick();
+	const auto first_tick = start.time_since_epoch() / base;
+	for (size_t i = 0; i != rates.size(); ++i)
+	{
+		time_list expected;
+		for (auto tick = first_tick; (tick - first_tick + 1) * base <= run_time; ++tick)
+			if ((tick * base) % rates[i] == virtual_clock::steady::duration::zero())
+				expected.push_back((tick - first_tick + 1) * base);
+		times[i].erase(std::remove_if(times[i].begin(), times[i].end(),
+				[run_time](auto t) { return t > run_time; }), times[i].end());
+		BOOST_CHECK(times[i] == expected);
+	}
+	return times;
+}
+}
+
+BOOST_AUTO_TEST_CASE(test_discrete_event_main_loop)
+{
+	using namespace std::chrono_literals;
+	const time_list rates{30ms, 70ms, 1s};
+	const auto afap = task_times(std::make_shared<thread::afap_main_loop>(), rates, 3s);
+	const auto discrete = task_times(
+			std::make_shared<thread::discrete_event_main_loop>(), rates, 3s);
+
+	BOOST_CHECK_EQUAL(afap[2].size(), 3);
+	BOOST_CHECK_EQUAL(discrete[2].size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_independent_clocks)
+{
+	namespace sched = fc::thread;
+	virtual_clock::context clock_a;
+	virtual_clock::context clock_b;
+	const auto default_start = virtual_clock::steady::now();
+
+	const auto make_controller = [](virtual_clock::context& context,
+			std::vector<virtual_clock::steady::time_point>& times)
+	{
+		auto controller = std::make_unique<sched::cycle_control>(
+				std::make_unique<sched::blocking_scheduler>(),
+				[](auto&) { return true; }, std::make_shared<sched::afap_main_loop>());
+		controller->set_clock_context(context);
+		controller->add_task(sched::periodic_task{[&times]
+		{
+			times.push_back(virtual_clock::steady::now());
+		}}, sched::cycle_control::fast_tick);
+		return controller;
+	};
+	std::vector<virtual_clock::steady::time_point> times_a;
+	std::vector<virtual_clock::steady::time_point> times_b;
+	auto controller_a = make_controller(clock_a, times_a);
+	auto controller_b = make_controller(clock_b, times_b);
+
+	// both simulations run concurrently without affecting each other's time
+	std::thread thread_a{[&] { for (int i = 0; i != 100; ++i) controller_a->work(); }};
+	std::thread thread_b{[&] { for (int i = 0; i != 50; ++i) controller_b->work(); }};
+	thread_a.join();
+	thread_b.join();
+
+	BOOST_REQUIRE_EQUAL(times_a.size(), 100);
+	BOOST_REQUIRE_EQUAL(times_b.size(), 50);
+	for (size_t i = 0; i != times_a.size(); ++i)
+		BOOST_CHECK(times_a[i].time_since_epoch() == sched::cycle_control::fast_tick * (i + 1));
+	for (size_t i = 0; i != times_b.size(); ++i)
+		BOOST_CHECK(times_b[i].time_since_epoch() == sched::cycle_control::fast_tick * (i + 1));
+	BOOST_CHECK(virtual_clock::steady::now() == default_start);
+}
+
+namespace
+{
+/// blocking scheduler counting the tasks it runs
+struct counting_scheduler : thread::blocking_scheduler
+{
+	explicit counting_scheduler(std::atomic<size_t>& count) : count(count) {}
+	void add_tasks(std::vector<thread::scheduled_task>& new_tasks) override
+	{
+		count += new_tasks.size();
+		blocking_scheduler::add_tasks(new_tasks);
+	}
+	std::atomic<size_t>& count;
+};
+}
+
+BOOST_AUTO_TEST_CASE(test_region_fusion)
+{
+	namespace sched = fc::thread;
+	using fc::operator>>;
+	using namespace std::chrono_literals;
+	std::atomic<size_t> nr_of_tasks{0};
+	sched::cycle_control controller{std::make_unique<counting_scheduler>(nr_of_tasks),
+			[](auto&) { return true; }, std::make_shared<sched::afap_main_loop>()};
+	controller.set_fusion_budget(100us);
+
+	std::vector<std::shared_ptr<parallel_region>> regions;
+	std::vector<int> work_counts(7, 0);
+	const auto add_region = [&](size_t index, wall_clock::steady::duration cost)
+	{
+		auto region = std::make_shared<parallel_region>(
+				"region " + std::to_string(index), sched::cycle_control::fast_tick);
+		region->declare_cost(cost);
+		region->work_tick() >> [&work_counts, index] { ++work_counts[index]; };
+		controller.add_task(sched::periodic_task{region}, sched::cycle_control::fast_tick);
+		regions.push_back(region);
+	};
+	// five cheap regions fit into two tasks with a cost of at most 100us.
+	for (size_t i = 0; i != 5; ++i)
+		add_region(i, 40us);
+	// expensive regions and regions without known cost are not fused.
+	add_region(5, 1ms);
+	add_region(6, wall_clock::steady::duration::zero());
+
+	// regions are fused on start
+	controller.start();
+	controller.stop();
+	nr_of_tasks = 0;
+	std::fill(work_counts.begin(), work_counts.end(), 0);
+	for (int i = 0; i != 10; ++i)
+		controller.work();
+
+	BOOST_CHECK_EQUAL(nr_of_tasks.load(), 10 * 5);
+	for (const int count : work_counts)
+		BOOST_CHECK_EQUAL(count, 10);
+}
+
+BOOST_AUTO_TEST_CASE(test_inline_execution)
+{
+	namespace sched = fc::thread;
+	using namespace std::chrono_literals;
+	auto loop = std::make_shared<sched::afap_main_loop>();
+	sched::cycle_control controller{std::make_unique<sched::parallel_scheduler>(),
+			[](auto& task) { return task.wait_until_done(sched::cycle_control::slow_tick); },
+			loop};
+	controller.set_inline_threshold(500us);
+
+	constexpr int nr_of_cheap_tasks = 3;
+	std::atomic<int> cheap_on_main_thread{0};
+	std::atomic<int> expensive_on_main_thread{0};
+	const auto main_thread = std::this_thread::get_id();
+	for (int i = 0; i != nr_of_cheap_tasks; ++i)
+	{
+		controller.add_task(sched::periodic_task{[&]
+		{
+			if (std::this_thread::get_id() == main_thread)
+				++cheap_on_main_thread;
+		}}, sched::cycle_control::fast_tick);
+	}
+	controller.add_task(sched::periodic_task{[&]
+	{
+		if (std::this_thread::get_id() == main_thread)
+			++expensive_on_main_thread;
+		std::this_thread::sleep_for(2ms);
+	}}, sched::cycle_control::fast_tick);
+
+	constexpr int cycles = 20;
+	for (int i = 0; i != cycles; ++i)
+		loop->loop_body([&controller] { controller.work(); });
+	loop->wait_for_current_tasks();
+
+	const auto stats = controller.execution_stats();
+	BOOST_CHECK_EQUAL(stats.inline_tasks, nr_of_cheap_tasks);
+	// every task is dispatched until its execution time has been measured.
+	BOOST_CHECK_GE(stats.inline_runs, nr_of_cheap_tasks * (cycles / 2));
+	BOOST_CHECK_GE(stats.dispatched_runs, cycles);
+	BOOST_CHECK_EQUAL(stats.inline_runs + stats.dispatched_runs,
+			(nr_of_cheap_tasks + 1) * cycles);
+	BOOST_CHECK_EQUAL(cheap_on_main_thread.load(), stats.inline_runs);
+	BOOST_CHECK_EQUAL(expensive_on_main_thread.load(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_task_statistics)
+{
+	namespace sched = fc::thread;
+	using fc::operator>>;
+	using namespace std::chrono_literals;
+	auto loop = std::make_shared<sched::afap_main_loop>();
+	sched::cycle_control controller{std::make_unique<sched::blocking_scheduler>(),
+			[](auto&) { return true; }, loop};
+
+	auto region = std::make_shared<parallel_region>("sensor", sched::cycle_control::fast_tick);
+	region->work_tick() >> [] { std::this_thread::sleep_for(200us); };
+	controller.add_task(sched::periodic_task{region}, sched::cycle_control::fast_tick);
+	sched::periodic_task logger{[] {}};
+	logger.set_name("logger");
+	controller.add_task(std::move(logger), sched::cycle_control::medium_tick);
+
+	constexpr int cycles = 20;
+	for (int i = 0; i != cycles; ++i)
+		loop->loop_body([&controller] { controller.work(); });
+	loop->wait_for_current_tasks();
+
+	auto stats = controller.task_stats();
+	BOOST_REQUIRE_EQUAL(stats.size(), 2);
+	// tasks are listed from fastest to slowest tick rate
+	BOOST_CHECK_EQUAL(stats[0].name, "sensor");
+	BOOST_CHECK(stats[0].tick == sched::cycle_control::fast_tick);
+	BOOST_CHECK_EQUAL(stats[1].name, "logger");
+	BOOST_CHECK(stats[1].tick == sched::cycle_control::medium_tick);
+
+	const auto& sensor = stats[0];
+	BOOST_CHECK_EQUAL(sensor.execution_time.count, cycles);
+	BOOST_CHECK_EQUAL(sensor.start_delay.count, cycles);
+	BOOST_CHECK_EQUAL(sensor.slack.count + sensor.deadline_misses, cycles);
+	BOOST_CHECK(sensor.execution_time.min >= 200us);
+	BOOST_CHECK(sensor.execution_time.percentile(50) >= sensor.execution_time.min);
+	BOOST_CHECK(sensor.execution_time.percentile(99) <= sensor.execution_time.max);
+	BOOST_CHECK(sensor.slack.max < sched::cycle_control::fast_tick);
+	BOOST_CHECK_GE(stats[1].execution_time.count, 1);
+
+	controller.reset_task_stats();
+	stats = controller.task_stats();
+	BOOST_CHECK_EQUAL(stats[0].execution_time.count, 0);
+	BOOST_CHECK_EQUAL(stats[1].execution_time.count, 0);
+}
+
+namespace
+{
+constexpr auto overrun_tick = std::chrono::milliseconds(10);
+constexpr int overrun_cycles = 6;
+
+/**
+ * runs a realtime loop for a few cycles, the second of which takes 3.5 ticks.
+ * \param elapsed is set to the virtual time which passed.
+ */
+thread::overrun_statistics run_late_cycle(std::unique_ptr<thread::overrun_policy> policy,
+		virtual_clock::steady::duration& elapsed)
+{
+	auto loop = std::make_shared<thread::realtime_main_loop>();
+	thread::cycle_control controller{std::make_unique<thread::blocking_scheduler>(),
+			[](auto&) { return true; }, loop, overrun_tick};
+	virtual_clock::context context;
+	controller.set_clock_context(context);
+	controller.set_overrun_policy(std::move(policy));
+	controller.add_task(thread::periodic_task{[] {}}, overrun_tick);
+
+	loop->arm();
+	for (int i = 0; i != overrun_cycles; ++i)
+	{
+		loop->loop_body([&controller, i]
+		{
+			controller.work();
+			if (i == 1)
+				std::this_thread::sleep_for(overrun_tick * 3.5);
+		});
+	}
+	virtual_clock::context::scope in_context{context};
+	elapsed = virtual_clock::steady::now().time_since_epoch();
+	return controller.overrun_stats();
+}
+}
+
+BOOST_AUTO_TEST_CASE(test_overrun_policies)
+{
+	virtual_clock::steady::duration elapsed{};
+
+	const auto caught_up = run_late_cycle(std::make_unique<thread::catch_up_policy>(), elapsed);
+	BOOST_CHECK_GE(caught_up.late_cycles, 2);
+	BOOST_CHECK_EQUAL(caught_up.caught_up_cycles, caught_up.late_cycles);
+	BOOST_CHECK_EQUAL(caught_up.skipped_ticks, 0);
+	BOOST_CHECK(elapsed == overrun_tick * overrun_cycles);
+
+	const auto skipped = run_late_cycle(std::make_unique<thread::skip_ticks_policy>(), elapsed);
+	BOOST_CHECK_GE(skipped.skipped_ticks, 2);
+	BOOST_CHECK_EQUAL(skipped.caught_up_cycles, 0);
+	// the virtual clock jumps over the skipped cycles
+	BOOST_CHECK(elapsed == overrun_tick * (overrun_cycles + skipped.skipped_ticks));
+
+	const auto stretched = run_late_cycle(std::make_unique<thread::stretch_tick_policy>(), elapsed);
+	BOOST_CHECK_GE(stretched.stretched_cycles, 1);
+	BOOST_CHECK_EQUAL(stretched.stretched_cycles, stretched.late_cycles);
+	BOOST_CHECK_EQUAL(stretched.skipped_ticks, 0);
+	BOOST_CHECK(elapsed == overrun_tick * overrun_cycles);
+}
+
+BOOST_AUTO_TEST_CASE(test_shed_slow_groups)
+{
+	namespace sched = fc::thread;
+	auto loop = std::make_shared<sched::afap_main_loop>();
+	sched::cycle_control controller{
+			std::make_unique<sched::parallel_scheduler>(sched::scheduler_config::with_threads(2)),
+			[](auto&) { return true; }, loop};
+	virtual_clock::context context;
+	controller.set_clock_context(context);
+	controller.set_overrun_policy(std::make_unique<sched::shed_slow_groups_policy>());
+
+	std::atomic<int> fast_runs{0};
+	std::atomic<int> slow_runs{0};
+	std::atomic<bool> release{false};
+	controller.add_task(sched::periodic_task{[&] { ++fast_runs; }},
+			sched::cycle_control::fast_tick);
+	controller.add_task(sched::periodic_task{[&]
+	{
+		++slow_runs;
+		while (!release)
+			std::this_thread::yield();
+	}}, sched::cycle_control::medium_tick);
+
+	// the slow task blocks during its first run, so the following two runs are shed.
+	for (int i = 0; i != 25; ++i)
+		controller.work();
+	release = true;
+	loop->wait_for_current_tasks();
+
+	const auto stats = controller.overrun_stats();
+	BOOST_CHECK_EQUAL(stats.shed_groups, 2);
+	BOOST_CHECK_EQUAL(slow_runs.load(), 1);
+	BOOST_CHECK_GT(fast_runs.load(), 0);
+}
+
+using wave_schedulers = boost::mpl::list<thread::parallel_scheduler, thread::blocking_scheduler>;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(test_regions_run_in_waves, scheduler_t, wave_schedulers)
+{
+	namespace sched = fc::thread;
+	using fc::operator>>;
+	sched::cycle_control controller{std::make_unique<scheduler_t>(),
+			[](auto& task) { return task.wait_until_done(sched::cycle_control::slow_tick); },
+			std::make_shared<sched::afap_main_loop>()};
+
+	std::mutex order_mutex;
+	std::vector<size_t> order;
+	std::vector<std::shared_ptr<parallel_region>> regions;
+	for (size_t wave : {2, 0, 1})
+	{
+		auto region = std::make_shared<parallel_region>(
+				"wave " + std::to_string(wave), sched::cycle_control::fast_tick);
+		region->wave = wave;
+		region->work_tick() >> [wave, &order, &order_mutex]
+		{
+			std::lock_guard<std::mutex> lock(order_mutex);
+			order.push_back(wave);
+		};
+		controller.add_task(sched::periodic_task{region}, sched::cycle_control::fast_tick);
+		regions.push_back(std::move(region));
+	}
+
+	controller.start();
+	while (true)
+	{
+		{
+			std::lock_guard<std::mutex> lock(order_mutex);
+			if (order.size() >= 30)
+				break;
+		}
+		std::this_thread::yield();
+	}
+	controller.stop();
+
+	std::lock_guard<std::mutex> lock(order_mutex);
+	for (size_t i = 0; i != order.size(); ++i)
+		BOOST_CHECK_EQUAL(order[i], i % 3);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(test_parallel_switch, scheduler_t, wave_schedulers)
+{
+	namespace sched = fc::thread;
+	using fc::operator>>;
+	auto loop = std::make_shared<sched::afap_main_loop>();
+	sched::cycle_control controller{std::make_unique<scheduler_t>(),
+			[](auto& task) { return task.wait_until_done(sched::cycle_control::slow_tick); },
+			loop};
+	virtual_clock::context context;
+	controller.set_clock_context(context);
+	controller.set_parallel_switch(3);
+
+	constexpr int nr_of_regions = 8;
+	std::atomic<int> switched{0};
+	std::atomic<int> expected{0};
+	std::atomic<int> early_work{0};
+	std::atomic<int> work_runs{0};
+	std::vector<std::shared_ptr<parallel_region>> regions;
+	for (int i = 0; i != nr_of_regions; ++i)
+	{
+		auto region = std::make_shared<parallel_region>(
+				"region " + std::to_string(i), sched::cycle_control::fast_tick);
+		region->switch_tick() >> [&switched] { ++switched; };
+		region->work_tick() >> [&]
+		{
+			// all buffers are switched before any work of the cycle starts
+			if (switched.load() != expected.load())
+				++early_work;
+			++work_runs;
+		};
+		controller.add_task(sched::periodic_task{region}, sched::cycle_control::fast_tick);
+		regions.push_back(std::move(region));
+	}
+
+	constexpr int cycles = 20;
+	for (int i = 0; i != cycles; ++i)
+	{
+		expected += nr_of_regions;
+		controller.work();
+		loop->wait_for_current_tasks();
+	}
+
+	BOOST_CHECK_EQUAL(switched.load(), cycles * nr_of_regions);
+	BOOST_CHECK_EQUAL(work_runs.load(), cycles * nr_of_regions);
+	BOOST_CHECK_EQUAL(early_work.load(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_switch_of_different_rates)
+{
+	namespace sched = fc::thread;
+	using fc::operator>>;
+	auto loop = std::make_shared<sched::afap_main_loop>();
+	sched::cycle_control controller{
+			std::make_unique<sched::parallel_scheduler>(sched::scheduler_config::with_threads(2)),
+			[](auto& task) { return task.wait_until_done(sched::cycle_control::slow_tick); },
+			loop};
+	virtual_clock::context context;
+	controller.set_clock_context(context);
+	controller.set_parallel_switch(2);
+
+	// buffers between tick rates are switched by regions of both rates,
+	// which therefore never switch at the same time.
+	std::atomic<int> switching[2] = {{0}, {0}};
+	std::atomic<int> overlaps{0};
+	std::vector<std::shared_ptr<parallel_region>> regions;
+	for (int rate = 0; rate != 2; ++rate)
+	{
+		const auto tick = rate == 0 ? sched::cycle_control::fast_tick
+				: sched::cycle_control::medium_tick;
+		for (int i = 0; i != 4; ++i)
+		{
+			auto region = std::make_shared<parallel_region>("region", tick);
+			region->switch_tick() >> [&switching, &overlaps, rate]
+			{
+				++switching[rate];
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+				if (switching[1 - rate].load() != 0)
+					++overlaps;
+				--switching[rate];
+			};
+			controller.add_task(sched::periodic_task{region}, tick);
+			regions.push_back(std::move(region));
+		}
+	}
+
+	for (int i = 0; i != 30; ++i)
+	{
+		controller.work();
+		loop->wait_for_current_tasks();
+	}
+	BOOST_CHECK_EQUAL(overlaps.load(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_dedicated_thread)
+{
+	namespace sched = fc::thread;
+	using fc::operator>>;
+	sched::cycle_control controller{
+			std::make_unique<sched::parallel_scheduler>(sched::scheduler_config::with_threads(2)),
+			[](auto& task) { return task.wait_until_done(sched::cycle_control::slow_tick); },
+			std::make_shared<sched::afap_main_loop>()};
+	virtual_clock::context context;
+	controller.set_clock_context(context);
+
+	std::mutex ids_mutex;
+	std::set<std::thread::id> pool_ids;
+	std::set<std::thread::id> dedicated_ids;
+	std::atomic<int> dedicated_runs{0};
+
+	auto pooled = std::make_shared<parallel_region>("pooled", sched::cycle_control::fast_tick);
+	pooled->work_tick() >> [&]
+	{
+		std::lock_guard<std::mutex> lock(ids_mutex);
+		pool_ids.insert(std::this_thread::get_id());
+	};
+	auto critical = std::make_shared<parallel_region>("critical", sched::cycle_control::fast_tick);
+	critical->run_on_dedicated_thread();
+	critical->work_tick() >> [&]
+	{
+		{
+			std::lock_guard<std::mutex> lock(ids_mutex);
+			dedicated_ids.insert(std::this_thread::get_id());
+		}
+		++dedicated_runs;
+	};
+	controller.add_task(sched::periodic_task{pooled}, sched::cycle_control::fast_tick);
+	controller.add_task(sched::periodic_task{critical}, sched::cycle_control::fast_tick);
+	// dedicated regions are never fused
+	pooled->declare_cost(std::chrono::microseconds(1));
+	critical->declare_cost(std::chrono::microseconds(1));
+	controller.set_fusion_budget(sched::cycle_control::slow_tick);
+
+	controller.start();
+	while (dedicated_runs.load() < 50)
+		std::this_thread::yield();
+	controller.stop();
+
+	BOOST_CHECK_EQUAL(dedicated_ids.size(), 1);
+	BOOST_CHECK(pool_ids.count(*dedicated_ids.begin()) == 0);
+	BOOST_CHECK(*dedicated_ids.begin() != std::this_thread::get_id());
+
+	// the dedicated region has the same accounting as any other task
+	const auto stats = controller.task_stats();
+	BOOST_REQUIRE_EQUAL(stats.size(), 2);
+	BOOST_CHECK_EQUAL(stats[1].name, "critical");
+	BOOST_CHECK_EQUAL(stats[1].execution_time.count, dedicated_runs.load());
+	BOOST_CHECK(!controller.last_exception());
+}
+
+BOOST_AUTO_TEST_CASE(test_dedicated_thread_invalid_cpu)
+{
+	// the thread is already running when pinning fails, it has to be joined, not terminated
+	fc::dedicated_thread_config config;
+	config.cpus = {-1};
+	BOOST_CHECK_THROW(fc::thread::detail::dedicated_worker{config}, std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_triggered_task)
+{
+	namespace sched = fc::thread;
+	using namespace std::chrono_literals;
+	using fc::operator>>;
+	sched::cycle_control controller{
+			std::make_unique<sched::parallel_scheduler>(sched::scheduler_config::with_threads(2)),
+			std::make_shared<sched::realtime_main_loop>(), 1ms};
+	virtual_clock::context context;
+	controller.set_clock_context(context);
+
+	const auto min_interval = 20ms;
+	auto triggered = std::make_shared<parallel_region>("triggered", 20ms);
+	BOOST_CHECK_THROW(controller.add_triggered_task(sched::periodic_task{triggered}),
+			std::invalid_argument);
+	triggered->trigger_on_events(min_interval);
+	controller.add_triggered_task(sched::periodic_task{triggered});
+
+	fc::event_inbox<int> inbox;
+	inbox.on_publish([&triggered] { triggered->data_arrived(); });
+	std::atomic<int> received{0};
+	std::atomic<int> runs{0};
+	triggered->switch_tick() >> inbox.collect_tick();
+	triggered->work_tick() >> inbox.work_tick();
+	triggered->work_tick() >> [&runs] { ++runs; };
+	inbox.out() >> [&received](int) { ++received; };
+
+	// data arriving before the start is processed once the controller runs
+	inbox.in()(0);
+	inbox.publish_tick()();
+	BOOST_CHECK_EQUAL(runs.load(), 0);
+
+	controller.start();
+	const auto begin = wall_clock::steady::now();
+	const int sent = 50;
+	for (int i = 1; i != sent; ++i)
+	{
+		inbox.in()(i);
+		inbox.publish_tick()();
+		std::this_thread::sleep_for(1ms);
+	}
+	const auto timeout = wall_clock::steady::now() + 1s;
+	while (received.load() < sent && wall_clock::steady::now() < timeout)
+		std::this_thread::sleep_for(1ms);
+	const auto elapsed = wall_clock::steady::now() - begin;
+	controller.stop();
+
+	// every event arrives, arrivals are coalesced into runs at least min_interval apart
+	BOOST_CHECK_EQUAL(received.load(), sent);
+	BOOST_CHECK_GE(runs.load(), 2);
+	BOOST_CHECK_LE(runs.load(), elapsed / min_interval + 2);
+	BOOST_CHECK_EQUAL(controller.execution_stats().triggered_runs, runs.load());
+
+	const auto stats = controller.task_stats();
+	BOOST_REQUIRE_EQUAL(stats.size(), 1);
+	BOOST_CHECK_EQUAL(stats[0].name, "triggered");
+	BOOST_CHECK_EQUAL(stats[0].execution_time.count, runs.load());
+	BOOST_CHECK(!controller.last_exception());
+}
+
+BOOST_AUTO_TEST_CASE(test_independent_work_ticks)
+{
+	namespace sched = fc::thread;
+	using namespace std::chrono_literals;
+	using fc::operator>>;
+	sched::cycle_control controller{
+			std::make_unique<sched::parallel_scheduler>(sched::scheduler_config::with_threads(4)),
+			[](auto& task) { return task.wait_until_done(sched::cycle_control::slow_tick); },
+			std::make_shared<sched::afap_main_loop>()};
+	virtual_clock::context context;
+	controller.set_clock_context(context);
+
+	constexpr int nr_of_lanes = 4;
+	auto region = std::make_shared<parallel_region>("region", sched::cycle_control::fast_tick);
+	std::atomic<int> active{0};
+	std::atomic<int> max_active{0};
+	std::atomic<int> lanes_done{0};
+	std::atomic<int> joined_cycles{0};
+	std::atomic<bool> prepared{false};
+	region->work_tick() >> [&] { prepared = true; };
+	for (int i = 0; i != nr_of_lanes; ++i)
+	{
+		region->independent_work_tick() >> [&]
+		{
+			BOOST_CHECK(prepared.load());
+			const int now_active = ++active;
+			int seen = max_active.load();
+			while (now_active > seen && !max_active.compare_exchange_weak(seen, now_active))
+				;
+			std::this_thread::sleep_for(1ms);
+			--active;
+			++lanes_done;
+		};
+	}
+	// the region is only done, once all of its lanes are
+	region->work_done() >> [&]
+	{
+		if (lanes_done.exchange(0) == nr_of_lanes)
+			++joined_cycles;
+		prepared = false;
+	};
+	controller.add_task(sched::periodic_task{region}, sched::cycle_control::fast_tick);
+
+	controller.start();
+	const auto timeout = wall_clock::steady::now() + 5s;
+	while (joined_cycles.load() < 20 && wall_clock::steady::now() < timeout)
+		std::this_thread::sleep_for(1ms);
+	controller.stop();
+
+	BOOST_CHECK_GE(joined_cycles.load(), 20);
+	BOOST_CHECK_GT(max_active.load(), 1);
+	BOOST_CHECK_LE(max_active.load(), nr_of_lanes);
+	BOOST_CHECK(!controller.last_exception());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
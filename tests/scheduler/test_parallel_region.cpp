@@ -4,6 +4,8 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <vector>
+
 // Little hack to get access to infrastructure internals
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpragmas"       // tell gcc to ignore the unknown warning below
@@ -36,6 +38,21 @@ constexpr auto fast_tick = fc::thread::cycle_control::fast_tick;
 
 using fc::operator>>;
 
+BOOST_AUTO_TEST_CASE(test_independent_work_ticks_without_scheduler)
+{
+	auto region = std::make_shared<fc::parallel_region>("r1", fast_tick);
+
+	std::vector<int> order;
+	region->work_tick() >> [&](){ order.push_back(0); };
+	region->independent_work_tick() >> [&](){ order.push_back(1); };
+	region->independent_work_tick() >> [&](){ order.push_back(2); };
+	BOOST_CHECK_EQUAL(region->ticks.nr_of_lanes(), 2);
+
+	// without a scheduler, independent work runs after the work tick, one after another
+	parallel_tester::work_tick(region);
+	BOOST_CHECK((order == std::vector<int>{0, 1, 2}));
+}
+
 BOOST_AUTO_TEST_CASE(test_region_ticks)
 {
 	auto region = std::make_shared<fc::parallel_region>("r1", fast_tick);
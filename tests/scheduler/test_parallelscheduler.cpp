@@ -10,7 +10,11 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
+#include <mutex>
+#include <thread>
 
 using namespace fc;
 
@@ -128,4 +132,126 @@ BOOST_AUTO_TEST_CASE(test_main_loop)
 
 }
 
+namespace
+{
+/**
+ * Blocks all workers, queues slow tasks with late deadlines followed by fast tasks
+ * with early deadlines and returns how many tasks finished after their deadline.
+ */
+int deadline_misses(thread::parallel_scheduler::queue_order order)
+{
+	using clock = wall_clock::steady;
+	const int nr_of_workers = thread::parallel_scheduler::num_threads();
+	const int nr_of_slow_tasks = 4 * nr_of_workers;
+	constexpr int nr_of_fast_tasks = 10;
+	const auto slow_work = std::chrono::milliseconds(5);
+
+	std::atomic<int> misses{0};
+	std::atomic<int> finished{0};
+	std::atomic<bool> release{false};
+	{
+		thread::parallel_scheduler scheduler{order};
+		for (int i = 0; i != nr_of_workers; ++i)
+			scheduler.add_task([&release]
+			{
+				while (!release)
+					std::this_thread::yield();
+			});
+
+		const auto now = clock::now();
+		const auto add = [&](clock::duration work, clock::time_point deadline)
+		{
+			thread::scheduling_hints hints;
+			hints.deadline = deadline;
+			scheduler.add_task([&, work, deadline]
+			{
+				std::this_thread::sleep_for(work);
+				if (clock::now() > deadline)
+					++misses;
+				++finished;
+			}, hints);
+		};
+		// slow region queued before the fast region
+		for (int i = 0; i != nr_of_slow_tasks; ++i)
+			add(slow_work, now + std::chrono::seconds(10));
+		for (int i = 0; i != nr_of_fast_tasks; ++i)
+			add(clock::duration::zero(), now + 2 * slow_work);
+
+		release = true;
+		while (finished != nr_of_slow_tasks + nr_of_fast_tasks)
+			std::this_thread::yield();
+	}
+	return misses;
+}
+}
+
+BOOST_AUTO_TEST_CASE(test_earliest_deadline_first)
+{
+	using order = thread::parallel_scheduler::queue_order;
+	const int fifo_misses = deadline_misses(order::fifo);
+	const int edf_misses = deadline_misses(order::earliest_deadline_first);
+	BOOST_TEST_MESSAGE("deadline misses fifo: " << fifo_misses << " edf: " << edf_misses);
+	BOOST_CHECK_LT(edf_misses, fifo_misses);
+}
+
+BOOST_AUTO_TEST_CASE(test_fifo_without_deadlines)
+{
+	std::vector<int> order;
+	std::mutex order_mutex;
+	std::atomic<bool> release{false};
+	std::atomic<int> finished{0};
+	constexpr int nr_of_tasks = 20;
+	{
+		thread::parallel_scheduler scheduler;
+		const int nr_of_workers = thread::parallel_scheduler::num_threads();
+		for (int i = 0; i != nr_of_workers; ++i)
+			scheduler.add_task([&release]
+			{
+				while (!release)
+					std::this_thread::yield();
+			});
+		for (int i = 0; i != nr_of_tasks; ++i)
+			scheduler.add_task([&, i]
+			{
+				{
+					std::lock_guard<std::mutex> lock(order_mutex);
+					order.push_back(i);
+				}
+				++finished;
+			});
+		release = true;
+		while (finished != nr_of_tasks)
+			std::this_thread::yield();
+	}
+	// with more than one worker, tasks may finish out of order
+	if (thread::parallel_scheduler::num_threads() == 1)
+		BOOST_CHECK(std::is_sorted(order.begin(), order.end()));
+	BOOST_CHECK_EQUAL(order.size(), nr_of_tasks);
+}
+
+BOOST_AUTO_TEST_CASE(test_add_batch_of_tasks)
+{
+	constexpr int nr_of_tasks = 100;
+	std::atomic<int> counter{0};
+	thread::scheduler_config config;
+	config.workers = {{{}, 0}, {{}, 1}};
+	thread::parallel_scheduler scheduler{config};
+
+	std::vector<thread::scheduled_task> batch;
+	for (int i = 0; i != nr_of_tasks; ++i)
+	{
+		thread::scheduled_task task{[&counter]{ ++counter; }};
+		// every other task is bound to the second worker
+		if (i % 2 == 0)
+			task.hints.worker_group = 1;
+		batch.push_back(std::move(task));
+	}
+	scheduler.add_tasks(batch);
+	BOOST_CHECK(batch.empty());
+
+	while (counter != nr_of_tasks)
+		std::this_thread::yield();
+	BOOST_CHECK_EQUAL(scheduler.nr_of_waiting_tasks(), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,129 @@
+#include "scheduler/parallelscheduler.hpp"
+#include "scheduler/schedulerconfig.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <sched.h>
+
+using namespace fc;
+
+BOOST_AUTO_TEST_SUITE(test_scheduler_config)
+
+namespace
+{
+/// adds nr_of_tasks tasks with the given hints and returns the ids of the threads executing them.
+std::set<std::thread::id> executing_threads(thread::parallel_scheduler& scheduler,
+		const thread::scheduling_hints& hints, int nr_of_tasks)
+{
+	std::set<std::thread::id> threads;
+	std::mutex threads_mutex;
+	std::atomic<int> finished{0};
+	for (int i = 0; i != nr_of_tasks; ++i)
+		scheduler.add_task([&]
+		{
+			{
+				std::lock_guard<std::mutex> lock(threads_mutex);
+				threads.insert(std::this_thread::get_id());
+			}
+			// give other workers the chance to take tasks as well
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+			++finished;
+		}, hints);
+	while (finished != nr_of_tasks)
+		std::this_thread::yield();
+	return threads;
+}
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_cpu_list)
+{
+	BOOST_CHECK(thread::parse_cpu_list("") == std::vector<int>{});
+	BOOST_CHECK(thread::parse_cpu_list("3") == std::vector<int>{3});
+	BOOST_CHECK((thread::parse_cpu_list("0-3,8,10-11\n")
+			== std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+}
+
+BOOST_AUTO_TEST_CASE(test_configurations)
+{
+	const auto threads = thread::scheduler_config::with_threads(3);
+	BOOST_CHECK_EQUAL(threads.workers.size(), 3);
+	BOOST_CHECK_EQUAL(threads.nr_of_groups(), 1);
+	BOOST_CHECK_THROW(thread::scheduler_config::with_threads(0), std::invalid_argument);
+
+	const auto pinned = thread::scheduler_config::pinned({0, 2});
+	BOOST_REQUIRE_EQUAL(pinned.workers.size(), 2);
+	BOOST_CHECK(pinned.workers[1].cpus == std::vector<int>{2});
+
+	const auto nodes = thread::numa_nodes();
+	BOOST_REQUIRE(!nodes.empty());
+	const auto numa = thread::scheduler_config::per_numa_node(2);
+	BOOST_CHECK_THROW(thread::scheduler_config::per_numa_node(-1), std::invalid_argument);
+	BOOST_CHECK_EQUAL(numa.workers.size(), 2 * nodes.size());
+	BOOST_CHECK_EQUAL(numa.nr_of_groups(), nodes.size());
+	BOOST_CHECK(numa.workers.front().cpus == nodes.front().cpus);
+	BOOST_CHECK(numa.workers.back().cpus == nodes.back().cpus);
+	BOOST_CHECK_EQUAL(numa.workers.back().group, nodes.size() - 1);
+	// groups are numbered densely, nodes keep the ids of the kernel
+	for (size_t i = 1; i < nodes.size(); ++i)
+		BOOST_CHECK_LT(nodes[i - 1].id, nodes[i].id);
+}
+
+BOOST_AUTO_TEST_CASE(test_thread_count)
+{
+	thread::parallel_scheduler scheduler{thread::scheduler_config::with_threads(3)};
+	BOOST_CHECK_EQUAL(scheduler.nr_of_threads(), 3);
+	const auto threads = executing_threads(scheduler, thread::scheduling_hints{}, 30);
+	BOOST_CHECK_LE(threads.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_pinned_workers)
+{
+	const int cpu = thread::numa_nodes().front().cpus.front();
+	thread::parallel_scheduler scheduler{thread::scheduler_config::pinned({cpu, cpu})};
+	BOOST_CHECK_EQUAL(scheduler.nr_of_threads(), 2);
+
+	std::atomic<int> cpu_of_task{-1};
+	std::atomic<bool> done{false};
+	scheduler.add_task([&]
+	{
+		cpu_of_task = sched_getcpu();
+		done = true;
+	});
+	while (!done)
+		std::this_thread::yield();
+	BOOST_CHECK_EQUAL(cpu_of_task.load(), cpu);
+
+	BOOST_CHECK_THROW(thread::parallel_scheduler{thread::scheduler_config::pinned({-1})},
+			std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_worker_groups)
+{
+	thread::scheduler_config config;
+	config.workers = {{{}, 0}, {{}, 0}, {{}, 1}};
+	thread::parallel_scheduler scheduler{config};
+
+	thread::scheduling_hints group_0;
+	group_0.worker_group = 0;
+	thread::scheduling_hints group_1;
+	group_1.worker_group = 1;
+
+	// the only worker of group 1 executes all tasks of its group
+	const auto threads_1 = executing_threads(scheduler, group_1, 20);
+	BOOST_CHECK_EQUAL(threads_1.size(), 1);
+	const auto threads_0 = executing_threads(scheduler, group_0, 20);
+	for (const auto id : threads_0)
+		BOOST_CHECK(threads_1.count(id) == 0);
+
+	// tasks for unknown groups are executed by any worker
+	thread::scheduling_hints unknown;
+	unknown.worker_group = 5;
+	BOOST_CHECK(!executing_threads(scheduler, unknown, 5).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -3,6 +3,8 @@
 #include "scheduler/serialschedulers.hpp"
 
 #include <future>
+#include <stdexcept>
+#include <vector>
 
 namespace
 {
@@ -29,6 +31,22 @@ BOOST_AUTO_TEST_CASE(test_cant_add_tasks_after_stopped)
 	BOOST_CHECK_THROW(scheduler->add_task([]{}), std::runtime_error);
 }
 
+BOOST_AUTO_TEST_CASE(test_add_batch_of_tasks)
+{
+	auto scheduler = make_blocking_scheduler();
+	std::vector<int> order;
+	std::vector<fc::thread::scheduled_task> batch;
+	for (int i = 0; i != 3; ++i)
+		batch.push_back(fc::thread::scheduled_task{[&order, i] { order.push_back(i); }});
+	scheduler->add_tasks(batch);
+	BOOST_CHECK((order == std::vector<int>{0, 1, 2}));
+	BOOST_CHECK(batch.empty());
+
+	scheduler->stop();
+	batch.push_back(fc::thread::scheduled_task{[]{}});
+	BOOST_CHECK_THROW(scheduler->add_tasks(batch), std::runtime_error);
+}
+
 BOOST_AUTO_TEST_CASE(test_nr_of_waiting_tasks)
 {
 	auto scheduler = make_blocking_scheduler();
@@ -52,5 +70,41 @@ BOOST_AUTO_TEST_CASE(test_nr_of_waiting_tasks)
 	check.join();
 	BOOST_CHECK(nr_was_one);
 }
+
+BOOST_AUTO_TEST_CASE(test_nr_of_waiting_tasks_from_tasks)
+{
+	auto scheduler = make_blocking_scheduler();
+	std::vector<size_t> waiting;
+	std::vector<fc::thread::scheduled_task> batch;
+	for (int i = 0; i != 3; ++i)
+		batch.push_back(fc::thread::scheduled_task{[&]
+		{
+			waiting.push_back(scheduler->nr_of_waiting_tasks());
+		}});
+	scheduler->add_tasks(batch);
+	// the calling task and the tasks behind it in the batch
+	BOOST_CHECK((waiting == std::vector<size_t>{3, 2, 1}));
+	BOOST_CHECK_EQUAL(scheduler->nr_of_waiting_tasks(), 0);
+
+	BOOST_CHECK_THROW(scheduler->add_task([] { throw std::runtime_error{"task failed"}; }),
+			std::runtime_error);
+	BOOST_CHECK_EQUAL(scheduler->nr_of_waiting_tasks(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_failing_task_in_batch)
+{
+	auto scheduler = make_blocking_scheduler();
+	std::vector<int> order;
+	std::vector<fc::thread::scheduled_task> batch;
+	batch.push_back(fc::thread::scheduled_task{[&order] { order.push_back(0); }});
+	batch.push_back(fc::thread::scheduled_task{[] { throw std::runtime_error{"task failed"}; }});
+	batch.push_back(fc::thread::scheduled_task{[&order] { order.push_back(2); }});
+	BOOST_CHECK_THROW(scheduler->add_tasks(batch), std::runtime_error);
+	// tasks which ran are consumed, thus adding the rest again runs every task once
+	BOOST_CHECK_EQUAL(batch.size(), 1);
+	BOOST_CHECK_EQUAL(scheduler->nr_of_waiting_tasks(), 0);
+	scheduler->add_tasks(batch);
+	BOOST_CHECK((order == std::vector<int>{0, 2}));
+}
 BOOST_AUTO_TEST_SUITE_END()
 
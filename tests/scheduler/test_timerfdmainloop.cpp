@@ -0,0 +1,121 @@
+#include "scheduler/cyclecontrol.hpp"
+#include "scheduler/latency_histogram.hpp"
+#include "scheduler/parallelscheduler.hpp"
+#include "scheduler/timerfdmainloop.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <thread>
+
+using namespace fc;
+
+BOOST_AUTO_TEST_SUITE(test_timerfd_main_loop)
+
+BOOST_AUTO_TEST_CASE(test_latency_histogram)
+{
+	using std::chrono::nanoseconds;
+	thread::latency_histogram histogram;
+	auto empty = histogram.snapshot();
+	BOOST_CHECK_EQUAL(empty.count, 0);
+	BOOST_CHECK(empty.percentile(50) == nanoseconds::zero());
+
+	for (int i = 1; i <= 100; ++i)
+		histogram.record(std::chrono::microseconds(i));
+	histogram.record(nanoseconds(-5)); // negative values count as zero
+
+	const auto stats = histogram.snapshot();
+	BOOST_CHECK_EQUAL(stats.count, 101);
+	BOOST_CHECK(stats.min == nanoseconds::zero());
+	BOOST_CHECK(stats.max == std::chrono::microseconds(100));
+	BOOST_CHECK(stats.mean == nanoseconds(5050000 / 101));
+	BOOST_CHECK(stats.percentile(100) == stats.max);
+	BOOST_CHECK(stats.percentile(0) == stats.min);
+
+	// percentiles are accurate to the resolution of a bucket
+	const auto median = stats.percentile(50).count();
+	BOOST_CHECK_GE(median, 50000 * 15 / 16);
+	BOOST_CHECK_LE(median, 50000 * 17 / 16);
+	const auto p99 = stats.percentile(99).count();
+	BOOST_CHECK_GE(p99, 99000 * 15 / 16);
+	BOOST_CHECK_LE(p99, 100000);
+
+	histogram.reset();
+	BOOST_CHECK_EQUAL(histogram.snapshot().count, 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_histogram_buckets)
+{
+	using histogram = thread::latency_histogram;
+	for (uint64_t value : {0ul, 1ul, 15ul, 16ul, 17ul, 1000ul, 123456789ul})
+	{
+		const auto index = histogram::bucket_index(value);
+		BOOST_CHECK_LE(value, histogram::bucket_upper_bound(index));
+		if (index > 0)
+			BOOST_CHECK_GT(value, histogram::bucket_upper_bound(index - 1));
+	}
+	BOOST_CHECK_EQUAL(histogram::bucket_index(uint64_t(1) << 62), histogram::nr_of_buckets - 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_concurrent_record)
+{
+	constexpr int nr_of_threads = 4;
+	constexpr int values_per_thread = 10000;
+	thread::latency_histogram histogram;
+	std::vector<std::thread> threads;
+	for (int t = 0; t != nr_of_threads; ++t)
+		threads.emplace_back([&histogram, t]
+		{
+			for (int i = 0; i != values_per_thread; ++i)
+				histogram.record(std::chrono::nanoseconds(i * nr_of_threads + t));
+		});
+	for (auto& t : threads)
+		t.join();
+
+	const auto stats = histogram.snapshot();
+	BOOST_CHECK_EQUAL(stats.count, nr_of_threads * values_per_thread);
+	BOOST_CHECK(stats.min == std::chrono::nanoseconds(0));
+	BOOST_CHECK(stats.max == std::chrono::nanoseconds(nr_of_threads * values_per_thread - 1));
+}
+
+/// runs cycle_control with a timerfd_main_loop and checks that ticks are paced and measured.
+BOOST_AUTO_TEST_CASE(test_runs_in_realtime)
+{
+	using clock = wall_clock::steady;
+	const auto base_tick = std::chrono::milliseconds(1);
+	constexpr int nr_of_ticks = 50;
+
+	for (const auto spin : {clock::duration::zero(), clock::duration(std::chrono::microseconds(200))})
+	{
+		auto loop = std::make_shared<thread::timerfd_main_loop>(spin);
+		BOOST_CHECK(loop->spin_duration() == spin);
+		thread::cycle_control controller{std::make_unique<thread::parallel_scheduler>(),
+				[](auto&) { return true; }, loop, base_tick};
+
+		std::atomic<int> count{0};
+		controller.add_task(thread::periodic_task{[&count]{ ++count; }}, base_tick);
+
+		const auto start = clock::now();
+		controller.start();
+		while (count.load() < nr_of_ticks)
+			std::this_thread::sleep_for(base_tick);
+		controller.stop();
+		const auto elapsed = clock::now() - start;
+
+		// the loop may not run faster than realtime
+		BOOST_CHECK(elapsed >= base_tick * (nr_of_ticks - 1));
+
+		const auto lateness = loop->lateness();
+		BOOST_CHECK_GE(lateness.count, nr_of_ticks - 1);
+		BOOST_CHECK(lateness.min >= std::chrono::nanoseconds::zero());
+		BOOST_CHECK(lateness.min <= lateness.mean);
+		BOOST_CHECK(lateness.mean <= lateness.max);
+		BOOST_CHECK(lateness.percentile(50) <= lateness.percentile(99));
+		BOOST_CHECK(lateness.percentile(99) <= lateness.max);
+
+		loop->reset_lateness();
+		BOOST_CHECK_EQUAL(loop->lateness().count, 0);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,111 @@
+#include "scheduler/cyclecontrol.hpp"
+#include "scheduler/workstealingscheduler.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <thread>
+
+using namespace fc;
+
+BOOST_AUTO_TEST_SUITE(test_work_stealing_scheduler)
+
+namespace
+{
+void wait_for(const std::atomic<int>& counter, int expected)
+{
+	while (counter.load() != expected)
+		std::this_thread::yield();
+}
+}
+
+BOOST_AUTO_TEST_CASE(test_executes_all_tasks)
+{
+	constexpr int nr_of_tasks = 1000;
+	std::atomic<int> counter{0};
+	thread::work_stealing_scheduler scheduler{4};
+	BOOST_CHECK_EQUAL(scheduler.nr_of_threads(), 4);
+
+	for (int i = 0; i != nr_of_tasks; ++i)
+		scheduler.add_task([&counter]{ ++counter; });
+
+	wait_for(counter, nr_of_tasks);
+	BOOST_CHECK_EQUAL(counter.load(), nr_of_tasks);
+	BOOST_CHECK_EQUAL(scheduler.nr_of_waiting_tasks(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_tasks_added_by_workers)
+{
+	constexpr int nr_of_parents = 50;
+	constexpr int children_per_parent = 20;
+	std::atomic<int> counter{0};
+	thread::work_stealing_scheduler scheduler{3};
+
+	for (int i = 0; i != nr_of_parents; ++i)
+	{
+		scheduler.add_task([&]
+		{
+			// these end up in the deque of the executing worker and may be stolen by others
+			for (int j = 0; j != children_per_parent; ++j)
+				scheduler.add_task([&counter]{ ++counter; });
+			++counter;
+		});
+	}
+
+	wait_for(counter, nr_of_parents * (children_per_parent + 1));
+	BOOST_CHECK_EQUAL(counter.load(), nr_of_parents * (children_per_parent + 1));
+}
+
+BOOST_AUTO_TEST_CASE(test_wakeup_after_idle)
+{
+	std::atomic<int> counter{0};
+	thread::work_stealing_scheduler scheduler{2};
+	for (int round = 1; round != 4; ++round)
+	{
+		// give the workers time to park
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		scheduler.add_task([&counter]{ ++counter; });
+		wait_for(counter, round);
+	}
+	BOOST_CHECK_EQUAL(counter.load(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_stop_with_pending_tasks)
+{
+	std::atomic<bool> release{false};
+	std::atomic<int> started{0};
+	auto scheduler = std::make_unique<thread::work_stealing_scheduler>(1);
+	scheduler->add_task([&]
+	{
+		++started;
+		while (!release.load())
+			std::this_thread::yield();
+	});
+	for (int i = 0; i != 10; ++i)
+		scheduler->add_task([]{});
+
+	wait_for(started, 1);
+	std::thread stopper{[&]{ scheduler->stop(); }};
+	release.store(true);
+	stopper.join();
+	scheduler.reset(); // tasks which were never started are discarded
+	BOOST_CHECK_EQUAL(started.load(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_cycle_control_with_work_stealing)
+{
+	using task = thread::periodic_task;
+	thread::cycle_control controller{std::make_unique<thread::work_stealing_scheduler>()};
+
+	std::atomic<int> counter{0};
+	for (int i = 0; i != 3; ++i)
+		controller.add_task(task([&counter]{ ++counter; }), thread::cycle_control::fast_tick);
+
+	controller.start();
+	while (counter.load() < 3)
+		std::this_thread::yield();
+	controller.stop();
+	BOOST_CHECK_GE(counter.load(), 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()